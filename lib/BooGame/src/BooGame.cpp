@@ -1,13 +1,14 @@
 #include "BooGame.h"
-#include <stdlib.h> // for random if needed
 
-// We need a way to get time. For now, let's assume update() is called ~30 times a second
-// or we can add a 'deltaTime' parameter.
-// For the blink logic which relies on millis(), we might need to inject time.
+// Movement and blink timing are defined per fixed step. update(dt) hands
+// real time to a FixedStep, which runs as many steps as it covers, so the
+// ghost moves at the same speed whatever rate the caller runs at.
 
 BooGame::BooGame() {
     ghostX = 0;
     ghostY = 0;
+    prevX = 0;
+    prevY = 0;
     velX = 0;
     velY = 0;
     blinking = false;
@@ -19,8 +20,11 @@ BooGame::BooGame() {
 void BooGame::init() {
     ghostX = SCREEN_WIDTH / 2 - GHOST_SIZE / 2;
     ghostY = SCREEN_HEIGHT / 2 - GHOST_SIZE / 2;
+    prevX = ghostX;
+    prevY = ghostY;
     velX = 1.2f;
     velY = 0.8f;
+    stepper.reset();
     
     // Reset state
     blinking = false;
@@ -32,6 +36,8 @@ void BooGame::init() {
 void BooGame::setPosition(float x, float y) {
     ghostX = x;
     ghostY = y;
+    prevX = x;
+    prevY = y;
 }
 
 void BooGame::setVelocity(float vx, float vy) {
@@ -39,11 +45,24 @@ void BooGame::setVelocity(float vx, float vy) {
     velY = vy;
 }
 
+int BooGame::update(unsigned long dtMillis) {
+    return stepper.run(dtMillis, [this] { update(); });
+}
+
+float BooGame::getRenderX() const {
+    return prevX + (ghostX - prevX) * stepper.pending() / STEP_MS;
+}
+
+float BooGame::getRenderY() const {
+    return prevY + (ghostY - prevY) * stepper.pending() / STEP_MS;
+}
+
 void BooGame::update() {
-    // Advance time (simulated 33ms per frame for now)
-    currentTime += 33; 
+    currentTime += STEP_MS;
 
     // Update position
+    prevX = ghostX;
+    prevY = ghostY;
     ghostX += velX;
     ghostY += velY;
 
@@ -74,3 +93,53 @@ void BooGame::update() {
         blinking = false;
     }
 }
+
+BooGame::State BooGame::saveState() const {
+    State state;
+    state.x = ghostX;
+    state.y = ghostY;
+    state.vx = velX;
+    state.vy = velY;
+    state.clockMs = currentTime;
+    state.lastBlinkMs = lastBlinkTime;
+    return state;
+}
+
+void BooGame::loadState(const State& state) {
+    setPosition(state.x, state.y);
+    setVelocity(state.vx, state.vy);
+    stepper.reset();
+    currentTime = state.clockMs;
+    lastBlinkTime = state.lastBlinkMs;
+    blinkStartTime = state.lastBlinkMs;
+    blinking = false;
+}
+
+// FNV-1a over each field's bytes, so floats hash by bit pattern
+static uint32_t hashField(uint32_t h, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t BooGame::stateHash() const {
+    uint32_t h = 2166136261u;
+    h = hashField(h, &ghostX, sizeof(ghostX));
+    h = hashField(h, &ghostY, sizeof(ghostY));
+    h = hashField(h, &velX, sizeof(velX));
+    h = hashField(h, &velY, sizeof(velY));
+    h = hashField(h, &prevX, sizeof(prevX));
+    h = hashField(h, &prevY, sizeof(prevY));
+    unsigned long pending = stepper.pending();
+    h = hashField(h, &pending, sizeof(pending));
+    h = hashField(h, &blinking, sizeof(blinking));
+    h = hashField(h, &lastBlinkTime, sizeof(lastBlinkTime));
+    h = hashField(h, &blinkStartTime, sizeof(blinkStartTime));
+    h = hashField(h, &currentTime, sizeof(currentTime));
+    uint64_t rngState = prng.stateWord();
+    h = hashField(h, &rngState, sizeof(rngState));
+    return h;
+}
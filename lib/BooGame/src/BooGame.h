@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <math.h>
+#include "FixedStep.h"
+#include "Pcg32.h"
 
 // Constants
 #define SCREEN_WIDTH 240
@@ -11,33 +13,68 @@
 
 class BooGame {
 public:
+    // The simulation always advances in steps of this size
+    static const unsigned long STEP_MS = FixedStep::STEP_MS;
+    // Longest catch-up in one update(dt); anything older is dropped
+    static const int MAX_STEPS = FixedStep::MAX_STEPS;
+
     BooGame();
 
     void init();
+
+    // Runs exactly one fixed step
     void update();
-    
-    // Getters for rendering/testing
+    // Adds dtMillis of real time and runs every step that is now due.
+    // Returns how many steps ran.
+    int update(unsigned long dtMillis);
+
+    // Getters for rendering/testing. getGhostX/Y are the latest step;
+    // getRenderX/Y blend the last two steps by the time not yet simulated,
+    // so motion stays smooth at any frame rate.
     float getGhostX() const { return ghostX; }
     float getGhostY() const { return ghostY; }
+    float getRenderX() const;
+    float getRenderY() const;
     bool isBlinking() const { return blinking; }
 
+    // The game's own random generator; scenes and effects draw from it so a
+    // game seeded alike plays out alike
+    void seed(uint64_t seed) { prng.seed(seed); }
+    Pcg32& rng() { return prng; }
+
+    // Hash of the complete simulation state, for replay checks
+    uint32_t stateHash() const;
+
+    // What a saved game keeps: enough for the ghost to carry on where it
+    // was. Sub-step timing and the blink in progress are not kept.
+    struct State {
+        float x, y;
+        float vx, vy;
+        uint32_t clockMs;      // Simulated time
+        uint32_t lastBlinkMs;
+    };
+    State saveState() const;
+    void loadState(const State& state);
+
     // Setters for testing
     void setPosition(float x, float y);
     void setVelocity(float vx, float vy);
 
 private:
     float ghostX, ghostY;
+    float prevX, prevY;    // Position one step back, for interpolation
     float velX, velY;
+    FixedStep stepper;     // Real time not yet simulated
     
     // Blink state
     bool blinking;
     unsigned long lastBlinkTime;
     unsigned long blinkStartTime;
-    
-    // Helper to simulate millis() locally if needed, 
-    // or we can pass delta time. For simplicity, we'll assume ~30fps 
-    // or pass in a time value.
+
+    // Simulated time, advanced STEP_MS per step
     unsigned long currentTime;
+
+    Pcg32 prng;
 };
 
 #endif
@@ -0,0 +1,86 @@
+#include "EffectBudget.h"
+
+// Shed a level when this many of the last 4 frames overran
+#define SHED_OVERRUNS 2
+// Restore a level after this many frames under 3/4 of the budget
+#define RESTORE_FRAMES 30
+
+static int popcount4(uint8_t bits) {
+    int n = 0;
+    for (int i = 0; i < 4; i++) n += (bits >> i) & 1;
+    return n;
+}
+
+EffectBudget::EffectBudget() {
+    numEffects = 0;
+    live = 0;
+    history = 0;
+    calmFrames = 0;
+    overrunCount = 0;
+    adjustCount = 0;
+}
+
+int EffectBudget::declare(const char* name, uint8_t priority, uint16_t fullCount) {
+    if (numEffects == MAX_EFFECTS) return -1;
+    effects[numEffects] = {name, priority, FULL_LEVEL, fullCount};
+    return numEffects++;
+}
+
+uint16_t EffectBudget::count(int id) const {
+    if (id < 0) return 0;
+    live |= 1 << id;
+    const Effect& e = effects[id];
+    return (e.fullCount * e.level + FULL_LEVEL - 1) / FULL_LEVEL;
+}
+
+uint8_t EffectBudget::level(int id) const {
+    if (id < 0) return FULL_LEVEL;
+    live |= 1 << id;
+    return effects[id].level;
+}
+
+void EffectBudget::endFrame(unsigned long workUs, unsigned long budgetUs) {
+    bool over = workUs > budgetUs;
+    history = (history << 1) | (over ? 1 : 0);
+
+    if (over) {
+        overrunCount++;
+        calmFrames = 0;
+        if (popcount4(history) >= SHED_OVERRUNS) {
+            shed();
+            history = 0;  // Give the lower level a few frames to show
+        }
+    } else if (workUs * 4 < budgetUs * 3) {
+        if (++calmFrames >= RESTORE_FRAMES) {
+            restore();
+            calmFrames = 0;
+        }
+    } else {
+        calmFrames = 0;
+    }
+    live = 0;
+}
+
+void EffectBudget::shed() {
+    int pick = -1;
+    for (int i = 0; i < numEffects; i++) {
+        if (!(live >> i & 1) || effects[i].level <= 1) continue;
+        if (pick < 0 || effects[i].priority < effects[pick].priority) pick = i;
+    }
+    if (pick >= 0) {
+        effects[pick].level--;
+        adjustCount++;
+    }
+}
+
+void EffectBudget::restore() {
+    int pick = -1;
+    for (int i = 0; i < numEffects; i++) {
+        if (!(live >> i & 1) || effects[i].level >= FULL_LEVEL) continue;
+        if (pick < 0 || effects[i].priority > effects[pick].priority) pick = i;
+    }
+    if (pick >= 0) {
+        effects[pick].level++;
+        adjustCount++;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef BOO_EFFECT_BUDGET_H
+#define BOO_EFFECT_BUDGET_H
+
+#include <stdint.h>
+
+// Level-of-detail control for decorative effects. Scenes declare each effect
+// with a priority and its full-detail count, ask for the current count every
+// frame, and report how long the frame took. When recent frames overrun the
+// budget the least important effect is scaled down one level; after a long
+// enough stretch with headroom the most important degraded effect comes back.
+// Only effects the frame read through count() or level() are shed or
+// restored, so a scene's overruns land on what that scene draws.
+class EffectBudget {
+public:
+    static const int MAX_EFFECTS = 8;
+    static const uint8_t FULL_LEVEL = 4;  // Levels run 1 (25%) .. 4 (100%)
+
+    EffectBudget();
+
+    // Higher priority effects are shed last. Returns the effect id, or -1
+    // when the table is full. An id of -1 is never shed and has no count,
+    // so the missing effect shows instead of taking another one's budget.
+    int declare(const char* name, uint8_t priority, uint16_t fullCount);
+
+    uint16_t count(int id) const;
+    uint8_t level(int id) const;
+    const char* name(int id) const { return id >= 0 ? effects[id].name : "?"; }
+    int size() const { return numEffects; }
+
+    // Report one rendered frame; starts the next frame's set of live effects
+    void endFrame(unsigned long workUs, unsigned long budgetUs);
+
+    unsigned long overruns() const { return overrunCount; }
+    unsigned long adjustments() const { return adjustCount; }
+
+private:
+    struct Effect {
+        const char* name;
+        uint8_t priority;
+        uint8_t level;
+        uint16_t fullCount;
+    };
+
+    void shed();
+    void restore();
+
+    Effect effects[MAX_EFFECTS];
+    uint8_t numEffects;
+    mutable uint8_t live;  // One bit per effect read since the last endFrame()
+    uint8_t history;       // One bit per recent frame, set if it overran
+    uint16_t calmFrames;   // Consecutive frames with comfortable headroom
+    unsigned long overrunCount;
+    unsigned long adjustCount;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef BOO_FIXED_STEP_H
+#define BOO_FIXED_STEP_H
+
+// Turns real time into whole fixed steps for the simulations (BooGame,
+// GhostCrowd, ParticlePool). run(dt) adds dt to an accumulator and makes one
+// step call per STEP_MS it covers; the rest waits for the next call. When
+// more than MAX_STEPS are due at once the caller has stalled, and the
+// backlog is dropped rather than caught up in a burst.
+class FixedStep {
+public:
+    // The simulations always advance in steps of this size
+    static const unsigned long STEP_MS = 33;
+    // Longest catch-up in one run(dt); anything older is dropped
+    static const int MAX_STEPS = 10;
+
+    FixedStep() : accumulator(0) {}
+
+    // Adds dtMillis of real time and calls step() for every step now due.
+    // Returns how many ran.
+    template <typename Step>
+    int run(unsigned long dtMillis, Step step) {
+        accumulator += dtMillis;
+        int steps = 0;
+        while (accumulator >= STEP_MS) {
+            if (steps == MAX_STEPS) {
+                accumulator = 0;
+                break;
+            }
+            step();
+            accumulator -= STEP_MS;
+            steps++;
+        }
+        return steps;
+    }
+
+    void reset() { accumulator = 0; }
+    // Real time not yet simulated, under STEP_MS
+    unsigned long pending() const { return accumulator; }
+
+private:
+    unsigned long accumulator;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef BOO_FIXED_TRIG_H
+#define BOO_FIXED_TRIG_H
+
+#include <stdint.h>
+
+// Table-driven sine and cosine on integer angles, for animation maths. An
+// angle is a uint16_t where 65536 is one full turn, so angles wrap for free.
+// Results are Q15: 32767 stands for 1.0. The error is about one Q15 step,
+// and a call is a table lookup plus a multiply. The ESP32-S3 FPU is single
+// precision only, so double sin()/cos() there is software emulation.
+#define TRIG_TURN 65536L
+#define TRIG_ONE 32767
+
+// Degrees to angle units, for constants
+#define TRIG_DEG(deg) ((uint16_t)((long)((deg) * TRIG_TURN / 360) & 0xFFFF))
+
+int16_t isin(uint16_t angle);
+
+inline int16_t icos(uint16_t angle) {
+    return isin((uint16_t)(angle + TRIG_TURN / 4));
+}
+
+#endif
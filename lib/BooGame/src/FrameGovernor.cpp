@@ -0,0 +1,56 @@
+#include "FrameGovernor.h"
+
+// Quiet time before stepping down to each band
+#define CALM_AFTER_MS 5000
+#define IDLE_AFTER_MS 30000
+
+FrameGovernor::FrameGovernor() {
+    reset(0);
+}
+
+void FrameGovernor::reset(unsigned long now) {
+    current = FULL;
+    lastActivity = now;
+    lastAccount = now;
+    for (int i = 0; i < BAND_COUNT; i++) bandMs[i] = 0;
+}
+
+void FrameGovernor::account(unsigned long now) {
+    bandMs[current] += now - lastAccount;
+    lastAccount = now;
+}
+
+void FrameGovernor::noteActivity(unsigned long now) {
+    account(now);
+    current = FULL;
+    lastActivity = now;
+}
+
+unsigned long FrameGovernor::framePeriod(unsigned long now) {
+    account(now);
+
+    unsigned long quiet = now - lastActivity;
+    if (quiet >= IDLE_AFTER_MS) current = IDLE;
+    else if (quiet >= CALM_AFTER_MS) current = CALM;
+    else current = FULL;
+
+    return periodOf(current);
+}
+
+unsigned long FrameGovernor::periodOf(Band b) {
+    switch (b) {
+        case CALM: return 66;   // ~15 FPS
+        case IDLE: return 100;  // 10 FPS
+        case FULL:
+        default:   return 33;   // ~30 FPS
+    }
+}
+
+const char* FrameGovernor::nameOf(Band b) {
+    switch (b) {
+        case CALM: return "CALM";
+        case IDLE: return "IDLE";
+        case FULL:
+        default:   return "FULL";
+    }
+}
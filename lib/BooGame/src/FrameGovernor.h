@@ -0,0 +1,38 @@
+#ifndef BOO_FRAME_GOVERNOR_H
+#define BOO_FRAME_GOVERNOR_H
+
+#include <stdint.h>
+
+// Picks the idle screen's frame period from what is actually going on.
+// Input and scenes run at full rate; once nothing but the slow ghost drift is
+// left the rate steps down, and any activity snaps it straight back up.
+class FrameGovernor {
+public:
+    enum Band { FULL, CALM, IDLE, BAND_COUNT };
+
+    FrameGovernor();
+
+    void reset(unsigned long now);
+
+    // Key press, scene start or end: jump back to full rate
+    void noteActivity(unsigned long now);
+
+    // Chooses the band for the next frame and returns its period in ms
+    unsigned long framePeriod(unsigned long now);
+
+    Band band() const { return current; }
+    unsigned long timeInBand(Band b) const { return bandMs[b]; }
+
+    static unsigned long periodOf(Band b);
+    static const char* nameOf(Band b);
+
+private:
+    void account(unsigned long now);
+
+    Band current;
+    unsigned long lastActivity;
+    unsigned long lastAccount;
+    unsigned long bandMs[BAND_COUNT];
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "FrameProfiler.h"
+#include <string.h>
+
+// Times below this many us get a bucket each; above it, each octave is split
+// into SUB_BUCKETS
+#define EXACT_US 16
+#define SUB_BUCKETS 4
+
+static int bucketOf(unsigned long us) {
+    if (us < EXACT_US) return (int)us;
+    int octave = 0;
+    while ((us >> octave) >= 2 * SUB_BUCKETS) octave++;
+    // us >> octave is now SUB_BUCKETS .. 2 * SUB_BUCKETS - 1
+    int bucket = EXACT_US + (octave - 2) * SUB_BUCKETS + (int)(us >> octave) - SUB_BUCKETS;
+    return bucket < FrameProfiler::BUCKETS ? bucket : FrameProfiler::BUCKETS - 1;
+}
+
+// Middle of the bucket's range
+static unsigned long bucketUs(int bucket) {
+    if (bucket < EXACT_US) return bucket;
+    int octave = (bucket - EXACT_US) / SUB_BUCKETS + 2;
+    unsigned long low = (unsigned long)(SUB_BUCKETS + (bucket - EXACT_US) % SUB_BUCKETS) << octave;
+    return low + (1UL << octave) / 2;
+}
+
+FrameProfiler::FrameProfiler(unsigned long (*clockUs)()) {
+    clock = clockUs;
+    numScenes = 0;
+    current = -1;
+    enabled = true;
+    depth = 0;
+    frameStartUs = 0;
+    memset(phaseUs, 0, sizeof(phaseUs));
+    memset(last, 0, sizeof(last));
+}
+
+FrameProfiler::~FrameProfiler() {
+    for (int i = 0; i < numScenes; i++) delete[] scenes[i].counts;
+}
+
+int FrameProfiler::declare(const char* name) {
+    if (numScenes == MAX_SCENES) return -1;
+    Scene& scene = scenes[numScenes];
+    scene.name = name;
+    scene.frames = 0;
+    memset(scene.maxUs, 0, sizeof(scene.maxUs));
+    scene.counts = 0;
+    return numScenes++;
+}
+
+void FrameProfiler::setScene(int scene) {
+    current = scene;
+    startFrame();
+}
+
+void FrameProfiler::startFrame() {
+    if (!enabled) return;
+    unsigned long now = clock();
+    frameStartUs = now;
+    memset(phaseUs, 0, sizeof(phaseUs));
+    // Scopes still open count from here
+    for (int i = 0; i < depth; i++) {
+        stack[i].startUs = now;
+        stack[i].childUs = 0;
+    }
+}
+
+void FrameProfiler::endFrame() {
+    if (!enabled) return;
+    if (current < 0) {
+        startFrame();
+        return;
+    }
+    unsigned long now = clock();
+    Scene& scene = scenes[current];
+    if (!scene.counts) {
+        scene.counts = new uint32_t[SERIES_COUNT * BUCKETS];
+        memset(scene.counts, 0, SERIES_COUNT * BUCKETS * sizeof(uint32_t));
+    }
+
+    unsigned long frameUs = now - frameStartUs;
+    unsigned long tracked = 0;
+    for (int p = 0; p <= FRAME; p++) {
+        unsigned long us;
+        if (p < PHASE_COUNT) {
+            us = phaseUs[p];
+            tracked += us;
+        } else if (p == OTHER) {
+            us = frameUs > tracked ? frameUs - tracked : 0;
+        } else if (p == WORK) {
+            unsigned long idle = phaseUs[SLEEP] + phaseUs[HUD];
+            us = frameUs > idle ? frameUs - idle : 0;
+        } else {
+            us = frameUs;
+        }
+        scene.counts[p * BUCKETS + bucketOf(us)]++;
+        if (us > scene.maxUs[p]) scene.maxUs[p] = us;
+        last[p] = us;
+    }
+    scene.frames++;
+
+    frameStartUs = now;
+    memset(phaseUs, 0, sizeof(phaseUs));
+}
+
+void FrameProfiler::begin(Phase phase) {
+    if (!enabled) return;
+    if (depth >= MAX_DEPTH) {
+        depth++;  // Too deep: only counted so end() stays balanced; the time goes to the parent
+        return;
+    }
+    Open& open = stack[depth++];
+    open.phase = (uint8_t)phase;
+    open.startUs = clock();
+    open.childUs = 0;
+}
+
+void FrameProfiler::end() {
+    if (!enabled || depth == 0) return;
+    if (depth-- > MAX_DEPTH) return;
+    Open& open = stack[depth];
+    unsigned long us = clock() - open.startUs;
+    phaseUs[open.phase] += us > open.childUs ? us - open.childUs : 0;
+    if (depth > 0) stack[depth - 1].childUs += us;
+}
+
+unsigned long FrameProfiler::percentile(int scene, int series, float fraction) const {
+    const Scene& s = scenes[scene];
+    if (!s.counts || s.frames == 0) return 0;
+    unsigned long target = (unsigned long)(fraction * s.frames + 0.999f);
+    if (target == 0) target = 1;
+    const uint32_t* counts = s.counts + series * BUCKETS;
+    unsigned long seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= target) {
+            unsigned long us = bucketUs(b);
+            return us < s.maxUs[series] ? us : s.maxUs[series];
+        }
+    }
+    return s.maxUs[series];
+}
+
+const char* FrameProfiler::seriesName(int series) {
+    static const char* const names[SERIES_COUNT] = {
+        "update", "clear", "draw", "ghost", "food", "effects", "text", "present", "input", "sleep", "hud", "other", "work", "frame"
+    };
+    return series >= 0 && series < SERIES_COUNT ? names[series] : "?";
+}
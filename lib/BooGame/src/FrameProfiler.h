@@ -0,0 +1,101 @@
+#ifndef BOO_FRAME_PROFILER_H
+#define BOO_FRAME_PROFILER_H
+
+#include <stdint.h>
+
+// Where each frame's time goes, per scene. Code marks its phases with
+// scoped timers (ProfileScope); endFrame() adds the frame's totals to the
+// current scene's histograms, from which p50, p99 and max are read.
+//
+// Scopes nest and time is counted exclusively: a ghost drawn inside a scene
+// draw counts as ghost, not draw. Whatever no scope covers (music, key
+// handling) is reported as "other"; the HUD overlay's own time is kept
+// apart from the frame's work. Histogram buckets are a quarter octave
+// wide, so percentiles are within 12%; max is exact. A scene's histograms
+// are allocated the first time it ends a frame.
+class FrameProfiler {
+public:
+    enum Phase { UPDATE, CLEAR, DRAW, GHOST, FOOD, EFFECTS, TEXT, PRESENT, INPUT, SLEEP, HUD, PHASE_COUNT };
+    // Series are the phases, then these: time no scope covered, the frame
+    // less its sleep and HUD, and the whole frame
+    static const int OTHER = PHASE_COUNT;
+    static const int WORK = PHASE_COUNT + 1;
+    static const int FRAME = PHASE_COUNT + 2;
+    static const int SERIES_COUNT = PHASE_COUNT + 3;
+
+    static const int MAX_SCENES = 10;
+    static const int MAX_DEPTH = 8;
+    static const int BUCKETS = 80;  // Up to ~1s; longer times land in the last
+
+    explicit FrameProfiler(unsigned long (*clockUs)());
+    ~FrameProfiler();
+
+    // Returns the scene id, or -1 when the table is full
+    int declare(const char* name);
+    // Switches scene and starts a new frame. Frames of scene -1 are timed
+    // but not recorded, so they never land in another scene's histograms.
+    void setScene(int scene);
+    // Drops whatever the current frame has collected and starts it afresh,
+    // for when a scene waits between its frames
+    void startFrame();
+    void endFrame();
+
+    void begin(Phase phase);
+    void end();
+
+    // Off: scopes and frames are ignored
+    void setEnabled(bool on) { enabled = on; }
+
+    int size() const { return numScenes; }
+    const char* name(int scene) const { return scene >= 0 ? scenes[scene].name : "?"; }
+    unsigned long frames(int scene) const { return scenes[scene].frames; }
+    // Time in us below which `fraction` of the scene's frames fall
+    unsigned long percentile(int scene, int series, float fraction) const;
+    unsigned long maxUs(int scene, int series) const { return scenes[scene].maxUs[series]; }
+    // The most recent frame, whichever scene it was in
+    unsigned long lastUs(int series) const { return last[series]; }
+
+    static const char* seriesName(int series);
+
+private:
+    FrameProfiler(const FrameProfiler&);
+    FrameProfiler& operator=(const FrameProfiler&);
+
+    struct Scene {
+        const char* name;
+        unsigned long frames;
+        unsigned long maxUs[SERIES_COUNT];
+        uint32_t* counts;  // SERIES_COUNT x BUCKETS
+    };
+    struct Open {
+        uint8_t phase;
+        unsigned long startUs;
+        unsigned long childUs;  // Time inside nested scopes
+    };
+
+    unsigned long (*clock)();
+    Scene scenes[MAX_SCENES];
+    int numScenes;
+    int current;
+    bool enabled;
+
+    Open stack[MAX_DEPTH];
+    int depth;
+    unsigned long frameStartUs;
+    unsigned long phaseUs[PHASE_COUNT];
+    unsigned long last[SERIES_COUNT];
+};
+
+// Times the enclosing block as one phase
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, FrameProfiler::Phase phase) : profiler(profiler) {
+        profiler.begin(phase);
+    }
+    ~ProfileScope() { profiler.end(); }
+
+private:
+    FrameProfiler& profiler;
+};
+
+#endif
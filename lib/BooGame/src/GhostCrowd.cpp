@@ -0,0 +1,66 @@
+#include "GhostCrowd.h"
+#include "BooGame.h"
+
+GhostCrowd::GhostCrowd(int capacity) {
+    cap = capacity > 0 ? capacity : 0;
+    count = 0;
+    posX = new float[cap];
+    posY = new float[cap];
+    velX = new float[cap];
+    velY = new float[cap];
+    blinkClock = new uint16_t[cap];
+
+    // Same playfield as the single BooGame ghost
+    maxX = SCREEN_WIDTH - GHOST_SIZE;
+    maxY = SCREEN_HEIGHT - GHOST_SIZE - 18;
+}
+
+GhostCrowd::~GhostCrowd() {
+    delete[] posX;
+    delete[] posY;
+    delete[] velX;
+    delete[] velY;
+    delete[] blinkClock;
+}
+
+void GhostCrowd::setBounds(float mx, float my) {
+    maxX = mx;
+    maxY = my;
+}
+
+int GhostCrowd::spawn(float x, float y, float vx, float vy, uint16_t blinkPhaseMs) {
+    if (count == cap) return -1;
+    posX[count] = x;
+    posY[count] = y;
+    velX[count] = vx;
+    velY[count] = vy;
+    blinkClock[count] = blinkPhaseMs % BLINK_PERIOD_MS;
+    return count++;
+}
+
+// One axis of the bounce: move, then reflect off either wall. Written as
+// selects rather than branches so the loop vectorises.
+static void moveAxis(float* __restrict pos, float* __restrict vel, int n, float limit) {
+    for (int i = 0; i < n; i++) {
+        float p = pos[i] + vel[i];
+        bool low = p <= 0.0f;
+        bool high = p >= limit;
+        pos[i] = low ? 0.0f : (high ? limit : p);
+        vel[i] = (low || high) ? -vel[i] : vel[i];
+    }
+}
+
+void GhostCrowd::step() {
+    moveAxis(posX, velX, count, maxX);
+    moveAxis(posY, velY, count, maxY);
+
+    uint16_t* __restrict clock = blinkClock;
+    for (int i = 0; i < count; i++) {
+        uint16_t c = clock[i] + STEP_MS;
+        clock[i] = c >= BLINK_PERIOD_MS ? c - BLINK_PERIOD_MS : c;
+    }
+}
+
+int GhostCrowd::update(unsigned long dtMillis) {
+    return stepper.run(dtMillis, [this] { step(); });
+}
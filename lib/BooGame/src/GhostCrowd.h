@@ -0,0 +1,53 @@
+#ifndef BOO_GHOST_CROWD_H
+#define BOO_GHOST_CROWD_H
+
+#include <stdint.h>
+#include "FixedStep.h"
+
+// Many ghosts drifting and bouncing like the BooGame one, stored as
+// structure-of-arrays so a step is a few straight loops over floats that the
+// compiler can vectorise. Storage is allocated once, up front.
+class GhostCrowd {
+public:
+    static const unsigned long STEP_MS = FixedStep::STEP_MS;  // Same step as BooGame
+    static const int MAX_STEPS = FixedStep::MAX_STEPS;
+    static const uint16_t BLINK_PERIOD_MS = 3000;
+    static const uint16_t BLINK_MS = 200;
+
+    explicit GhostCrowd(int capacity);
+    ~GhostCrowd();
+
+    // Largest top-left corner a ghost may reach; the minimum is 0, 0
+    void setBounds(float maxX, float maxY);
+
+    // Velocity is in px per step. Returns the ghost's index, or -1 when full.
+    int spawn(float x, float y, float vx, float vy, uint16_t blinkPhaseMs = 0);
+    void clear() { count = 0; }
+
+    // Advances every ghost one fixed step, bouncing off the bounds
+    void step();
+    // Runs the steps covered by dtMillis of real time; returns how many ran
+    int update(unsigned long dtMillis);
+
+    int size() const { return count; }
+    int capacity() const { return cap; }
+    float x(int i) const { return posX[i]; }
+    float y(int i) const { return posY[i]; }
+    bool isBlinking(int i) const { return blinkClock[i] < BLINK_MS; }
+
+private:
+    GhostCrowd(const GhostCrowd&);
+    GhostCrowd& operator=(const GhostCrowd&);
+
+    float* posX;
+    float* posY;
+    float* velX;
+    float* velY;
+    uint16_t* blinkClock;  // ms into the current blink period
+    int count;
+    int cap;
+    FixedStep stepper;
+    float maxX, maxY;
+};
+
+#endif
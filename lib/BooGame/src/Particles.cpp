@@ -0,0 +1,106 @@
+#include "Particles.h"
+#include "BooGame.h"
+
+ParticlePool::ParticlePool(int capacity) {
+    cap = capacity > 0 ? capacity : 0;
+    count = 0;
+    posX = new float[cap];
+    posY = new float[cap];
+    velX = new float[cap];
+    velY = new float[cap];
+    lives = new uint16_t[cap];
+    sizes = new uint8_t[cap];
+    colors = new uint16_t[cap];
+    setBounds(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1);
+}
+
+ParticlePool::~ParticlePool() {
+    delete[] posX;
+    delete[] posY;
+    delete[] velX;
+    delete[] velY;
+    delete[] lives;
+    delete[] sizes;
+    delete[] colors;
+}
+
+void ParticlePool::setBounds(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    minX = x0;
+    minY = y0;
+    maxX = x1;
+    maxY = y1;
+}
+
+// Emitter ranges are inclusive
+static float pick(Pcg32& rng, float lo, float hi) {
+    return lo + (hi - lo) * rng.unit();
+}
+
+static int pick(Pcg32& rng, int lo, int hi) {
+    return rng.between(lo, hi + 1);
+}
+
+int ParticlePool::spawn(float x, float y, float vx, float vy, uint16_t life, uint8_t size, uint16_t color) {
+    if (count == cap || life == 0) return -1;
+    posX[count] = x;
+    posY[count] = y;
+    velX[count] = vx;
+    velY[count] = vy;
+    lives[count] = life;
+    sizes[count] = size;
+    colors[count] = color;
+    return count++;
+}
+
+int ParticlePool::emit(const ParticleEmitter& e, int n, Pcg32& rng) {
+    int spawned = 0;
+    for (; spawned < n && count < cap; spawned++) {
+        spawn(pick(rng, e.x, e.x + e.w), pick(rng, e.y, e.y + e.h),
+              pick(rng, e.vxMin, e.vxMax), pick(rng, e.vyMin, e.vyMax),
+              pick(rng, e.lifeMin, e.lifeMax), pick(rng, e.sizeMin, e.sizeMax),
+              rng.below(2) ? e.altColor : e.color);
+    }
+    return spawned;
+}
+
+int ParticlePool::trickle(const ParticleEmitter& e, uint8_t percent, Pcg32& rng) {
+    int want = 0;
+    for (int free = cap - count; free > 0; free--) {
+        if (rng.below(100) < percent) want++;
+    }
+    return emit(e, want, rng);
+}
+
+// Swap the last live particle into the hole; order within a pool is not kept
+void ParticlePool::remove(int i) {
+    count--;
+    posX[i] = posX[count];
+    posY[i] = posY[count];
+    velX[i] = velX[count];
+    velY[i] = velY[count];
+    lives[i] = lives[count];
+    sizes[i] = sizes[count];
+    colors[i] = colors[count];
+}
+
+// One axis of the move, a straight loop so it vectorises. The restrict
+// pointers live only in here; the cull below goes through the members.
+static void moveAxis(float* __restrict pos, const float* __restrict vel, int n) {
+    for (int i = 0; i < n; i++) pos[i] += vel[i];
+}
+
+void ParticlePool::step() {
+    moveAxis(posX, velX, count);
+    moveAxis(posY, velY, count);
+
+    // Age and cull; walk backwards so a swapped-in particle was already seen
+    for (int i = count - 1; i >= 0; i--) {
+        bool gone = --lives[i] == 0 ||
+                    posX[i] < minX || posX[i] > maxX || posY[i] < minY || posY[i] > maxY;
+        if (gone) remove(i);
+    }
+}
+
+int ParticlePool::update(unsigned long dtMillis) {
+    return stepper.run(dtMillis, [this] { step(); });
+}
@@ -0,0 +1,75 @@
+#ifndef BOO_PARTICLES_H
+#define BOO_PARTICLES_H
+
+#include <stdint.h>
+#include "FixedStep.h"
+#include "Pcg32.h"
+
+// How one kind of particle is born: where it appears and how it moves, lives
+// and looks. Ranges are inclusive; equal ends give every particle the same value.
+struct ParticleEmitter {
+    int16_t x, y, w, h;          // Spawn area; w = h = 0 spawns on the point
+    float vxMin, vxMax;          // px per step
+    float vyMin, vyMax;
+    uint16_t lifeMin, lifeMax;   // Steps
+    uint8_t sizeMin, sizeMax;
+    uint16_t color, altColor;    // Each particle takes one of the two at random
+};
+
+// A fixed-capacity pool of one kind of particle, stored as structure-of-arrays
+// and stepped in batch. Particles die when their life runs out or they leave
+// the bounds; the survivors stay packed at the front, so a scene draws a
+// whole pool with one loop. Storage is allocated once, up front; emitting
+// draws from the generator the caller passes in.
+class ParticlePool {
+public:
+    static const unsigned long STEP_MS = FixedStep::STEP_MS;
+    static const int MAX_STEPS = FixedStep::MAX_STEPS;
+
+    explicit ParticlePool(int capacity);
+    ~ParticlePool();
+
+    // Particles are culled once they leave minX..maxX, minY..maxY
+    void setBounds(int16_t minX, int16_t minY, int16_t maxX, int16_t maxY);
+
+    // Returns the particle's index, or -1 when the pool is full
+    int spawn(float x, float y, float vx, float vy, uint16_t life, uint8_t size, uint16_t color);
+    // Spawns up to n particles from the emitter; returns how many fit
+    int emit(const ParticleEmitter& e, int n, Pcg32& rng);
+    // Gives every free slot a percent chance of a new particle
+    int trickle(const ParticleEmitter& e, uint8_t percent, Pcg32& rng);
+    void clear() { count = 0; }
+
+    // Moves and ages every particle one fixed step
+    void step();
+    // Runs the steps covered by dtMillis of real time; returns how many ran
+    int update(unsigned long dtMillis);
+
+    int size() const { return count; }
+    int capacity() const { return cap; }
+    float x(int i) const { return posX[i]; }
+    float y(int i) const { return posY[i]; }
+    uint8_t particleSize(int i) const { return sizes[i]; }
+    uint16_t color(int i) const { return colors[i]; }
+    uint16_t life(int i) const { return lives[i]; }
+
+private:
+    ParticlePool(const ParticlePool&);
+    ParticlePool& operator=(const ParticlePool&);
+
+    void remove(int i);
+
+    float* posX;
+    float* posY;
+    float* velX;
+    float* velY;
+    uint16_t* lives;
+    uint8_t* sizes;
+    uint16_t* colors;
+    int count;
+    int cap;
+    FixedStep stepper;
+    int16_t minX, minY, maxX, maxY;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#include "Pcg32.h"
+
+void Pcg32::seed(uint64_t seed, uint64_t stream) {
+    state = 0;
+    inc = (stream << 1) | 1;
+    next();
+    state += seed;
+    next();
+}
+
+// Lemire's multiply-shift: the high word of next() * bound is the result.
+// Only the few low words that would bias it are redrawn.
+uint32_t Pcg32::below(uint32_t bound) {
+    if (bound == 0) return 0;
+    uint64_t m = (uint64_t)next() * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            m = (uint64_t)next() * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
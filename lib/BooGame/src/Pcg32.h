@@ -0,0 +1,45 @@
+#ifndef BOO_PCG32_H
+#define BOO_PCG32_H
+
+#include <stdint.h>
+
+// PCG32 (O'Neill, pcg-random.org): a 64-bit LCG whose output is permuted down
+// to 32 bits. Small, fast and statistically solid. Each instance has its own
+// state and stream, so two games seeded alike draw alike and never share
+// hidden globals the way rand() does.
+class Pcg32 {
+public:
+    static const uint64_t DEFAULT_STREAM = 0xda3e39cb94b95bdbULL;
+
+    explicit Pcg32(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = DEFAULT_STREAM) {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream = DEFAULT_STREAM);
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // Uniform in [0, bound), without modulo bias
+    uint32_t below(uint32_t bound);
+    // Uniform in [lo, hi), like Arduino's random(lo, hi)
+    int32_t between(int32_t lo, int32_t hi) {
+        return hi > lo ? lo + (int32_t)below((uint32_t)(hi - lo)) : lo;
+    }
+    // Uniform in [0, 1)
+    float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // For state hashes
+    uint64_t stateWord() const { return state; }
+
+private:
+    uint64_t state;
+    uint64_t inc;  // Stream selector, always odd
+};
+
+#endif
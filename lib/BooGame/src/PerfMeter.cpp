@@ -0,0 +1,47 @@
+#include "PerfMeter.h"
+
+PerfMeter::PerfMeter() {
+    started = false;
+    windowStartUs = 0;
+    frames = 0;
+    workTotal = 0;
+    workMax = 0;
+    drawTotal = 0;
+    pixelTotal = 0;
+    shownFps = 0;
+    shownWorkAvg = 0;
+    shownWorkMax = 0;
+    shownDrawCalls = 0;
+    shownPixels = 0;
+}
+
+void PerfMeter::frame(unsigned long nowUs, unsigned long workUs, uint32_t drawCalls, uint32_t pixels) {
+    // The first frame only opens the window; its start time is unknown
+    if (!started) {
+        started = true;
+        windowStartUs = nowUs;
+        return;
+    }
+
+    frames++;
+    workTotal += workUs;
+    if (workUs > workMax) workMax = workUs;
+    drawTotal += drawCalls;
+    pixelTotal += pixels;
+
+    unsigned long elapsed = nowUs - windowStartUs;
+    if (elapsed < WINDOW_US) return;
+
+    shownFps = frames * 1000000.0f / elapsed;
+    shownWorkAvg = workTotal / frames;
+    shownWorkMax = workMax;
+    shownDrawCalls = drawTotal / frames;
+    shownPixels = pixelTotal / frames;
+
+    windowStartUs = nowUs;
+    frames = 0;
+    workTotal = 0;
+    workMax = 0;
+    drawTotal = 0;
+    pixelTotal = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef BOO_PERF_METER_H
+#define BOO_PERF_METER_H
+
+#include <stdint.h>
+
+// Frame statistics for the on-screen HUD. Frames are gathered over a short
+// window and published as averages when it closes, so the numbers hold
+// still long enough to read.
+class PerfMeter {
+public:
+    static const unsigned long WINDOW_US = 500000;
+
+    PerfMeter();
+
+    // One finished frame: when it ended, its work time and what it drew
+    void frame(unsigned long nowUs, unsigned long workUs, uint32_t drawCalls, uint32_t pixels);
+
+    // Of the last full window; all zero until one has closed
+    float fps() const { return shownFps; }
+    unsigned long workUsAvg() const { return shownWorkAvg; }
+    unsigned long workUsMax() const { return shownWorkMax; }
+    uint32_t drawCalls() const { return shownDrawCalls; }  // Per frame
+    uint32_t pixels() const { return shownPixels; }        // Per frame
+
+private:
+    bool started;
+    unsigned long windowStartUs;
+    uint32_t frames;
+    unsigned long workTotal;
+    unsigned long workMax;
+    unsigned long drawTotal;
+    unsigned long pixelTotal;
+
+    float shownFps;
+    unsigned long shownWorkAvg;
+    unsigned long shownWorkMax;
+    uint32_t shownDrawCalls;
+    uint32_t shownPixels;
+};
+
+#endif
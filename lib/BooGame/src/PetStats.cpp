@@ -0,0 +1,124 @@
+#include "PetStats.h"
+
+#define SECONDS_PER_HOUR 3600u
+
+// Feeding and playing, in stat points
+#define FEED_HUNGER 300
+#define FEED_HAPPINESS 100
+#define PLAY_HAPPINESS 150
+#define PLAY_HUNGER 50
+
+// Stats are worked out in parts of a point: one point is SECONDS_PER_HOUR
+// parts, so a rate in points per hour is also parts per second
+#define PARTS SECONDS_PER_HOUR
+
+static uint16_t clampStat(int64_t v) {
+    if (v < 0) return 0;
+    if (v > PetStats::MAX) return PetStats::MAX;
+    return (uint16_t)v;
+}
+
+// Splits parts into whole points and the fraction left, clamped to 0..MAX
+static void setParts(uint16_t* points, uint16_t* part, int64_t parts) {
+    if (parts <= 0) {
+        *points = 0;
+        *part = 0;
+    } else if (parts >= (int64_t)PetStats::MAX * PARTS) {
+        *points = PetStats::MAX;
+        *part = 0;
+    } else {
+        *points = (uint16_t)(parts / PARTS);
+        *part = (uint16_t)(parts % PARTS);
+    }
+}
+
+static void addPoints(uint16_t* points, uint16_t* part, int delta) {
+    setParts(points, part, ((int64_t)*points + delta) * PARTS + *part);
+}
+
+PetStats::PetStats() {
+    hatch(0);
+}
+
+void PetStats::hatch(uint32_t now) {
+    state.anchorAt = now;
+    state.ageSec = 0;
+    state.hunger = 0;
+    state.happiness = 800;
+    state.hungerPart = 0;
+    state.happinessPart = 0;
+}
+
+void PetStats::restore(const PetState& saved, uint32_t now) {
+    state = saved;
+    state.hunger = clampStat(state.hunger);
+    state.happiness = clampStat(state.happiness);
+    if (state.hungerPart >= PARTS) state.hungerPart = 0;
+    if (state.happinessPart >= PARTS) state.happinessPart = 0;
+    if (now < state.anchorAt) state.anchorAt = now;
+}
+
+uint32_t PetStats::elapsed(uint32_t now) const {
+    return now > state.anchorAt ? now - state.anchorAt : 0;
+}
+
+uint32_t PetStats::ageSeconds(uint32_t now) const {
+    return state.ageSec + elapsed(now);
+}
+
+int64_t PetStats::hungerParts(uint32_t now) const {
+    return (int64_t)state.hunger * PARTS + state.hungerPart + (int64_t)elapsed(now) * HUNGER_PER_HOUR;
+}
+
+uint16_t PetStats::hunger(uint32_t now) const {
+    return clampStat(hungerParts(now) / PARTS);
+}
+
+// Seconds after the anchor at which hunger first reaches HUNGRY
+uint32_t PetStats::hungryAfter() const {
+    int64_t toGo = (int64_t)HUNGRY * PARTS - ((int64_t)state.hunger * PARTS + state.hungerPart);
+    if (toGo <= 0) return 0;
+    return (uint32_t)((toGo + HUNGER_PER_HOUR - 1) / HUNGER_PER_HOUR);
+}
+
+uint32_t PetStats::secondsUntilHungry(uint32_t now) const {
+    uint32_t at = hungryAfter();
+    uint32_t dt = elapsed(now);
+    return at > dt ? at - dt : 0;
+}
+
+// Happiness drains at one rate until the pet turns hungry and at another
+// after, so it is two straight segments split at the hungry moment
+int64_t PetStats::happinessParts(uint32_t now) const {
+    int64_t dt = elapsed(now);
+    int64_t calm = hungryAfter();
+    if (calm > dt) calm = dt;
+    int64_t loss = calm * GLOOM_PER_HOUR + (dt - calm) * HUNGRY_GLOOM_PER_HOUR;
+    return (int64_t)state.happiness * PARTS + state.happinessPart - loss;
+}
+
+uint16_t PetStats::happiness(uint32_t now) const {
+    int64_t parts = happinessParts(now);
+    return parts > 0 ? clampStat(parts / PARTS) : 0;
+}
+
+void PetStats::rebase(uint32_t now) {
+    int64_t hungerNow = hungerParts(now);
+    int64_t happinessNow = happinessParts(now);
+    state.ageSec = ageSeconds(now);
+    setParts(&state.hunger, &state.hungerPart, hungerNow);
+    setParts(&state.happiness, &state.happinessPart, happinessNow);
+    state.anchorAt = now > state.anchorAt ? now : state.anchorAt;
+}
+
+void PetStats::feed(uint32_t now) {
+    rebase(now);
+    addPoints(&state.hunger, &state.hungerPart, -FEED_HUNGER);
+    addPoints(&state.happiness, &state.happinessPart, FEED_HAPPINESS);
+}
+
+void PetStats::play(uint32_t now) {
+    rebase(now);
+    addPoints(&state.happiness, &state.happinessPart, PLAY_HAPPINESS);
+    addPoints(&state.hunger, &state.hungerPart, PLAY_HUNGER);
+}
@@ -0,0 +1,63 @@
+#ifndef BOO_PET_STATS_H
+#define BOO_PET_STATS_H
+
+#include <stdint.h>
+
+// Everything needed to bring the pet back: its stats as they stood at one
+// moment (the anchor), and that moment on the caller's seconds clock.
+// The fractions of a point carry time that has not yet made a whole point,
+// so re-anchoring often loses none; they come last so a state saved without
+// them loads with zeros.
+struct PetState {
+    uint32_t anchorAt;    // Clock seconds when the stats below were taken
+    uint32_t ageSec;      // Age at the anchor
+    uint16_t hunger;      // 0 (full) .. PetStats::MAX (starving)
+    uint16_t happiness;   // 0 .. PetStats::MAX
+    uint16_t hungerPart;     // Fractions of a point above the whole ones,
+    uint16_t happinessPart;  // in 1/3600ths
+};
+
+// Age, hunger and happiness as closed-form functions of time since the last
+// anchor. Nothing ticks: reading a stat after a second or after a week of
+// deep sleep costs the same, so the caller only has to keep the anchor.
+// Hunger rises at a steady rate; happiness drains slowly, and faster once the
+// pet is hungry. Actions re-anchor at the current time.
+class PetStats {
+public:
+    static const uint16_t MAX = 1000;             // Stats are in tenths of a percent
+    static const uint16_t HUNGRY = 700;
+    static const uint16_t HUNGER_PER_HOUR = 50;   // Empty to starving in 20h
+    static const uint16_t GLOOM_PER_HOUR = 20;
+    static const uint16_t HUNGRY_GLOOM_PER_HOUR = 60;
+
+    PetStats();
+
+    // A new pet: age 0, not hungry, fairly happy
+    void hatch(uint32_t now);
+    // Picks up a saved pet. If the clock reads earlier than the anchor (it
+    // restarted after a power cut) the time away is unknown and counts as none.
+    void restore(const PetState& saved, uint32_t now);
+    const PetState& saved() const { return state; }
+
+    uint32_t ageSeconds(uint32_t now) const;
+    uint16_t hunger(uint32_t now) const;
+    uint16_t happiness(uint32_t now) const;
+    bool isHungry(uint32_t now) const { return hunger(now) >= HUNGRY; }
+    // Seconds until the pet turns hungry, 0 if it already is. A sleeping
+    // device can set its wake timer from this.
+    uint32_t secondsUntilHungry(uint32_t now) const;
+
+    void feed(uint32_t now);
+    void play(uint32_t now);
+
+private:
+    uint32_t elapsed(uint32_t now) const;
+    int64_t hungerParts(uint32_t now) const;
+    int64_t happinessParts(uint32_t now) const;
+    uint32_t hungryAfter() const;
+    void rebase(uint32_t now);
+
+    PetState state;
+};
+
+#endif
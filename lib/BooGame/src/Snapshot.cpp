@@ -0,0 +1,42 @@
+#include "Snapshot.h"
+#include <string.h>
+
+#define SNAPSHOT_HEADER 6
+
+static uint32_t fnv1a(const uint8_t* p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t snapshotWrite(uint8_t version, const void* payload, size_t len, uint8_t* out, size_t outLen) {
+    if (len > 0xFFFF || outLen < len + SNAPSHOT_OVERHEAD) return 0;
+    out[0] = 'B';
+    out[1] = 'S';
+    out[2] = version;
+    out[3] = 0;
+    out[4] = (uint8_t)len;
+    out[5] = (uint8_t)(len >> 8);
+    memcpy(out + SNAPSHOT_HEADER, payload, len);
+
+    uint32_t sum = fnv1a(out, SNAPSHOT_HEADER + len);
+    uint8_t* tail = out + SNAPSHOT_HEADER + len;
+    for (int i = 0; i < 4; i++) tail[i] = (uint8_t)(sum >> (8 * i));
+    return len + SNAPSHOT_OVERHEAD;
+}
+
+bool snapshotRead(uint8_t version, const uint8_t* data, size_t dataLen, void* payload, size_t len) {
+    if (dataLen != len + SNAPSHOT_OVERHEAD) return false;
+    if (data[0] != 'B' || data[1] != 'S' || data[2] != version || data[3] != 0) return false;
+    if ((size_t)(data[4] | (data[5] << 8)) != len) return false;
+
+    const uint8_t* tail = data + SNAPSHOT_HEADER + len;
+    uint32_t sum = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((uint32_t)tail[3] << 24);
+    if (fnv1a(data, SNAPSHOT_HEADER + len) != sum) return false;
+
+    memcpy(payload, data + SNAPSHOT_HEADER, len);
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef BOO_SNAPSHOT_H
+#define BOO_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Frames a plain-old-data payload for storage: "BS", version, a zero byte,
+// payload length (u16), the payload, then FNV-1a of all of it (u32).
+// Integers are little-endian; the payload is stored as-is, so a snapshot is
+// only read back by the build that wrote it, which the version byte guards.
+#define SNAPSHOT_OVERHEAD 10
+
+// Returns the bytes written to out, or 0 if out is too small
+size_t snapshotWrite(uint8_t version, const void* payload, size_t len, uint8_t* out, size_t outLen);
+
+// Fills payload and returns true only if the data holds a snapshot of this
+// version and length with a matching checksum; payload is untouched otherwise
+bool snapshotRead(uint8_t version, const uint8_t* data, size_t dataLen, void* payload, size_t len);
+
+#endif
@@ -0,0 +1,78 @@
+#include "Song.h"
+
+// Octave 8 (MIDI 108..119) in quarter Hz; lower octaves are shifts of these
+static const uint16_t topOctave[12] = {
+    16744, 17740, 18795, 19912, 21096, 22351, 23680, 25088, 26580, 28160, 29834, 31609
+};
+
+#define MAX_PITCH 119
+
+uint16_t pitchToHz(uint8_t pitch) {
+    if (pitch == 0) return 0;
+    if (pitch > MAX_PITCH) pitch = MAX_PITCH;
+    int shift = 2 + (9 - pitch / 12);  // Quarter Hz, then down from octave 8
+    return (topOctave[pitch % 12] + (1 << (shift - 1))) >> shift;
+}
+
+SongPlayer::SongPlayer() {
+    song = nullptr;
+    pos = 0;
+    dueAt = 0;
+    played = 0;
+    limit = 0;
+    lateTotal = 0;
+    lateMax = 0;
+    lateCount = 0;
+    resyncCount = 0;
+}
+
+void SongPlayer::start(const Song* s, unsigned long now, unsigned long maxNotes) {
+    song = s;
+    pos = 0;
+    dueAt = now;
+    played = 0;
+    limit = maxNotes;
+}
+
+void SongPlayer::stop() {
+    song = nullptr;
+}
+
+bool SongPlayer::finished() const {
+    if (limit > 0 && played >= limit) return true;
+    return song->loopStart < 0 && pos >= song->length;
+}
+
+bool SongPlayer::done(unsigned long now) const {
+    if (song == nullptr) return true;
+    return finished() && (long)(now - dueAt) >= 0;
+}
+
+bool SongPlayer::next(unsigned long now, SongEvent* event) {
+    if (song == nullptr || song->length == 0 || finished()) return false;
+    if ((long)(now - dueAt) < 0) return false;
+
+    SongNote note = song->notes[pos];
+    unsigned long step = (unsigned long)(note & 0x1FF) * song->tickMs;
+
+    // Nobody polled for a whole note (the player sat out a scene): pick the
+    // tune up from here rather than rattling through the backlog
+    unsigned long late = now - dueAt;
+    if (late > step) {
+        dueAt = now;
+        late = 0;
+        resyncCount++;
+    }
+    lateTotal += late;
+    if (late > lateMax) lateMax = late;
+    lateCount++;
+
+    event->freq = pitchToHz(note >> 9);
+    event->ms = step > song->gapMs ? step - song->gapMs : 1;
+    event->index = played;
+
+    dueAt += step;
+    played++;
+    if (++pos >= song->length && song->loopStart >= 0) pos = song->loopStart;
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef BOO_SONG_H
+#define BOO_SONG_H
+
+#include <stdint.h>
+
+// One packed note: MIDI pitch in the top 7 bits (0 is a rest) and its length
+// in song ticks in the low 9 bits. A song is a const array of these plus a
+// small header, so it costs 2 bytes a note and stays in flash.
+typedef uint16_t SongNote;
+
+#define SONG_NOTE(pitch, ticks) ((SongNote)(((pitch) << 9) | ((ticks) & 0x1FF)))
+#define SONG_REST(ticks) SONG_NOTE(0, ticks)
+
+struct Song {
+    const SongNote* notes;
+    uint8_t length;
+    int8_t loopStart;  // Note to jump back to after the last one, -1 to play once
+    uint8_t tickMs;    // Tempo: how long one tick lasts
+    uint8_t gapMs;     // Silence at the end of every note so repeats are heard
+};
+
+// A note the player wants sounded now
+struct SongEvent {
+    uint16_t freq;        // 0 for a rest
+    uint16_t ms;          // How long to sound it
+    unsigned long index;  // Notes started before this one
+};
+
+// Frequency of a MIDI pitch, rounded to the nearest Hz (0 for a rest)
+uint16_t pitchToHz(uint8_t pitch);
+
+// Walks a song against whatever millisecond clock the caller uses. Notes are
+// scheduled on the song's own grid, so late polling never drifts the tempo;
+// the player does not touch the speaker and can be driven from any loop.
+class SongPlayer {
+public:
+    SongPlayer();
+
+    // maxNotes > 0 ends the song after that many notes, loops included
+    void start(const Song* song, unsigned long now, unsigned long maxNotes = 0);
+    void stop();
+
+    // Returns the next due note, if any. Call until it returns false.
+    bool next(unsigned long now, SongEvent* event);
+
+    bool playing() const { return song != nullptr; }
+    // True once the last note has played out in full
+    bool done(unsigned long now) const;
+    unsigned long nextAt() const { return dueAt; }
+    unsigned long notesPlayed() const { return played; }
+
+    // How far behind their grid time notes were started, over the player's life
+    unsigned long lateMsAvg() const { return lateCount ? lateTotal / lateCount : 0; }
+    unsigned long lateMsMax() const { return lateMax; }
+    unsigned long notesTimed() const { return lateCount; }
+    unsigned long resyncs() const { return resyncCount; }
+
+private:
+    bool finished() const;
+
+    const Song* song;
+    uint8_t pos;
+    unsigned long dueAt;
+    unsigned long played;
+    unsigned long limit;
+    unsigned long lateTotal;
+    unsigned long lateMax;
+    unsigned long lateCount;
+    unsigned long resyncCount;
+};
+
+#endif
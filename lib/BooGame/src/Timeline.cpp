@@ -0,0 +1,72 @@
+#include "Timeline.h"
+#include "FixedTrig.h"
+
+float ease(Ease curve, float u) {
+    if (u <= 0.0f) return 0.0f;
+    if (u >= 1.0f) return 1.0f;
+
+    switch (curve) {
+        case Ease::Step:      return 0.0f;
+        case Ease::InQuad:    return u * u;
+        case Ease::OutQuad:   return u * (2.0f - u);
+        case Ease::InOutQuad: return u < 0.5f ? 2.0f * u * u : -1.0f + (4.0f - 2.0f * u) * u;
+        case Ease::InOutSine: return 0.5f - (0.5f / TRIG_ONE) * icos((uint16_t)(u * (TRIG_TURN / 2)));
+        case Ease::Linear:
+        default:              return u;
+    }
+}
+
+Track::Track(std::initializer_list<Keyframe> list, Playback playback) : count(0), playback(playback) {
+    for (const Keyframe& key : list) {
+        if (count == MAX_KEYS) break;
+        keys[count++] = key;
+    }
+}
+
+float Track::at(long t) const {
+    if (count == 0) return 0.0f;
+
+    // Fold t into the track's own time range
+    long length = (long)duration();
+    if (length > 0) {
+        if (playback == Playback::Loop) {
+            t %= length;
+            if (t < 0) t += length;
+        } else if (playback == Playback::PingPong) {
+            t %= 2 * length;
+            if (t < 0) t += 2 * length;
+            if (t > length) t = 2 * length - t;
+        }
+    }
+
+    if (t <= (long)keys[0].at) return keys[0].value;
+
+    for (int i = 0; i < count - 1; i++) {
+        const Keyframe& a = keys[i];
+        const Keyframe& b = keys[i + 1];
+        if (t < (long)b.at) {
+            float u = (float)(t - (long)a.at) / (float)(b.at - a.at);
+            return a.value + (b.value - a.value) * ease(a.curve, u);
+        }
+    }
+    return keys[count - 1].value;
+}
+
+Sequence::Sequence(std::initializer_list<uint32_t> list) : count(0), total(0) {
+    for (uint32_t ms : list) {
+        if (count == MAX_PHASES) break;
+        phases[count++] = ms;
+        total += ms;
+    }
+}
+
+int Sequence::locate(unsigned long t, unsigned long* local) const {
+    for (int i = 0; i < count; i++) {
+        if (t < phases[i]) {
+            if (local) *local = t;
+            return i;
+        }
+        t -= phases[i];
+    }
+    return -1;
+}
@@ -0,0 +1,72 @@
+#ifndef BOO_TIMELINE_H
+#define BOO_TIMELINE_H
+
+#include <stdint.h>
+#include <initializer_list>
+
+// Time-based animation. A Track is a short list of eased keyframes that is
+// evaluated at a timestamp, so what ends up on screen depends only on how many
+// milliseconds have passed, never on how many frames were rendered.
+
+enum class Ease : uint8_t {
+    Linear,
+    Step,       // Hold the value until the next key
+    InQuad,
+    OutQuad,
+    InOutQuad,
+    InOutSine,
+};
+
+// Maps progress u (0..1) through an easing curve
+float ease(Ease curve, float u);
+
+enum class Playback : uint8_t {
+    Once,      // Hold the last value once the end is reached
+    Loop,      // Jump back to the first key
+    PingPong,  // Play forwards, then backwards
+};
+
+struct Keyframe {
+    uint32_t at;   // ms from the start of the track
+    float value;
+    Ease curve;    // Curve used on the way to the next key
+};
+
+class Track {
+public:
+    static const int MAX_KEYS = 6;
+
+    Track(std::initializer_list<Keyframe> keys, Playback playback = Playback::Once);
+
+    // Value t ms after the track started. t may be negative for looping
+    // tracks, which is handy for phase offsets.
+    float at(long t) const;
+
+    uint32_t duration() const { return count ? keys[count - 1].at : 0; }
+
+private:
+    Keyframe keys[MAX_KEYS];
+    uint8_t count;
+    Playback playback;
+};
+
+// Back-to-back phases of fixed length, e.g. the steps of a scene
+class Sequence {
+public:
+    static const int MAX_PHASES = 8;
+
+    Sequence(std::initializer_list<uint32_t> phaseMs);
+
+    // Returns the phase index containing t and the time into that phase,
+    // or -1 once the whole sequence has played.
+    int locate(unsigned long t, unsigned long* local) const;
+
+    uint32_t duration() const { return total; }
+
+private:
+    uint32_t phases[MAX_PHASES];
+    uint8_t count;
+    uint32_t total;
+};
+
+#endif
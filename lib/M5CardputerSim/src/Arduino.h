@@ -9,6 +9,7 @@
 #include <string>
 #include <algorithm>
 #include <vector>
+#include <type_traits>
 #include <stdarg.h>
 #include <stdio.h> // for vsnprintf
 
@@ -32,13 +33,15 @@ public:
 #undef round
 #undef constrain
 
+// Return by value: decltype(a < b ? a : b) is a reference to a parameter
+// when both arguments have the same type.
 template <typename T, typename U>
-auto min(T a, U b) -> decltype(a < b ? a : b) {
+auto min(T a, U b) -> typename std::common_type<T, U>::type {
     return (a < b) ? a : b;
 }
 
 template <typename T, typename U>
-auto max(T a, U b) -> decltype(a > b ? a : b) {
+auto max(T a, U b) -> typename std::common_type<T, U>::type {
     return (a > b) ? a : b;
 }
 
@@ -63,12 +66,14 @@ T constrain(T amt, L low, H high) {
 
 // Time
 unsigned long millis();
+unsigned long micros();
 void delay(unsigned long ms);
 
 // Random
 long random(long max);
 long random(long min, long max);
 void randomSeed(long seed);
+uint32_t esp_random();  // ESP32 hardware RNG
 
 // IO (Stubbed)
 int analogRead(uint8_t pin);
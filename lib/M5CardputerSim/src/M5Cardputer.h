@@ -2,7 +2,7 @@
 #define M5Cardputer_h
 
 #include "Arduino.h"
-#include <vector>
+#include <stddef.h>
 
 // Forward declare for M5Canvas
 class M5Canvas;
@@ -50,27 +50,109 @@ public:
 
 // ================= Input Classes =================
 
+// One key going down or up, stamped with micros() at the moment SDL saw it
+struct KeyEvent {
+    char key;
+    bool down;
+    unsigned long us;
+};
+
+// Fixed-capacity FIFO of key events. When it is full the oldest event is
+// dropped, so a burst of input never allocates.
+class KeyEventRing {
+public:
+    static const int CAPACITY = 32;  // Power of two
+
+    class const_iterator {
+    public:
+        const_iterator(const KeyEventRing* ring, uint32_t pos) : ring(ring), pos(pos) {}
+        const KeyEvent& operator*() const { return ring->events[pos & (CAPACITY - 1)]; }
+        const KeyEvent* operator->() const { return &**this; }
+        const_iterator& operator++() { pos++; return *this; }
+        bool operator!=(const const_iterator& other) const { return pos != other.pos; }
+        bool operator==(const const_iterator& other) const { return pos == other.pos; }
+    private:
+        const KeyEventRing* ring;
+        uint32_t pos;
+    };
+
+    KeyEventRing() : head(0), tail(0), overflows(0) {}
+
+    void push(const KeyEvent& e) {
+        if (head - tail == CAPACITY) { tail++; overflows++; }
+        events[head++ & (CAPACITY - 1)] = e;
+    }
+    void clear() { tail = head; }
+    bool empty() const { return head == tail; }
+    int size() const { return (int)(head - tail); }
+    unsigned long dropped() const { return overflows; }
+
+    const_iterator begin() const { return const_iterator(this, tail); }
+    const_iterator end() const { return const_iterator(this, head); }
+
+private:
+    KeyEvent events[CAPACITY];
+    uint32_t head;
+    uint32_t tail;
+    unsigned long overflows;
+};
+
+// Fixed-capacity stand-in for the vector M5Cardputer uses in KeysState
+class KeyList {
+public:
+    static const int CAPACITY = 16;
+
+    KeyList() : count(0) {}
+    void clear() { count = 0; }
+    void push_back(char key) { if (count < CAPACITY) keys[count++] = key; }
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    char operator[](size_t i) const { return keys[i]; }
+    const char* begin() const { return keys; }
+    const char* end() const { return keys + count; }
+
+private:
+    char keys[CAPACITY];
+    uint8_t count;
+};
+
 class Keyboard_Class {
 public:
     struct KeysState {
-        std::vector<char> word;
+        KeyList word;  // Keys that went down this frame
     };
 
-    bool isChange();
-    bool isPressed();
-    KeysState keysState();
-    
-    // Sim helper
-    void setKeys(std::vector<char> keys); 
+    // Views over the events update() collected for this frame
+    bool isChange();                 // Any key went down or up
+    bool isPressed();                // Any key is held right now
+    const KeysState& keysState();
+    const KeyEventRing& events();    // This frame's events, oldest first
+
+    // Sim helper: feeds one SDL key transition
+    void pushEvent(const KeyEvent& e);
+    // Sim helper: makes the events gathered since the last call current
+    void nextFrame();
+
+private:
+    KeyEventRing pending;
+    KeyEventRing frame;
+    KeysState state;
+    bool held[128] = {};
+    int heldCount = 0;
 };
 
 // ================= Audio Classes =================
 
+// Mirrors the M5Unified speaker: 8 channels, each with its own volume.
+// channel -1 picks a free channel; stop_current_sound replaces whatever the
+// channel is playing instead of layering on top of it.
 class Speaker_Class {
 public:
     void setVolume(uint8_t volume);
-    void tone(uint16_t frequency, uint32_t duration);
+    void setChannelVolume(uint8_t channel, uint8_t volume);
+    void tone(uint16_t frequency, uint32_t duration = UINT32_MAX, int channel = -1, bool stop_current_sound = true);
     void stop();
+    void stop(uint8_t channel);
 };
 
 // ================= Main Hardware Class =================
@@ -98,4 +180,70 @@ public:
 };
 extern M5_Class M5;
 
+// ================= Simulator Diagnostics =================
+// Host-side counters; not part of the real M5Cardputer API.
+
+struct SimCpuStats {
+    unsigned long wallMs;         // Wall time since begin()
+    unsigned long cpuMs;          // Process CPU time since begin(), all threads
+    float cpuPercent;             // cpuMs / wallMs, 100 = one core busy
+    unsigned long delayCalls;
+    unsigned long delayWakeups;   // delay() wake-ups caused by input events
+    unsigned long delayLateUsAvg; // How late delay() returned past its deadline
+    unsigned long delayLateUsMax;
+};
+
+SimCpuStats simCpuStats();
+
+struct SimAudioStats {
+    unsigned long buffers;          // Callbacks so far
+    unsigned long long samples;     // Samples produced by the callback
+    unsigned long periodUs;         // Audio in one buffer
+    unsigned long callbackUsAvg;    // Time spent inside the callback
+    unsigned long callbackUsMax;
+    unsigned long intervalUsAvg;    // Time between callback starts
+    unsigned long intervalUsMin;
+    unsigned long intervalUsMax;
+    unsigned long underruns;        // Buffers the device ran dry before
+    unsigned long lastUnderrunMs;   // millis() of the most recent one, 0 if none
+    float loadPercent;              // callbackUsAvg / periodUs
+    float loadPercentMax;           // callbackUsMax / periodUs
+};
+
+// Safe to call from the main loop while audio is running
+SimAudioStats simAudioStats();
+
+struct SimPrefsStats {
+    unsigned long entries;          // Keys stored, all namespaces
+    unsigned long puts;
+    unsigned long putsUnchanged;    // Puts that stored the value already there
+    unsigned long commits;          // Writes of the preferences file
+    unsigned long long bytesWritten;
+    unsigned long fileBytes;        // Size of the last file read or written
+    unsigned long commitUsAvg;      // Encode + write + rename
+    unsigned long commitUsMax;
+};
+
+SimPrefsStats simPrefsStats();
+
+// Host benchmarks: a framebuffer for the canvas without opening a window,
+// and no "LCD:" echo of canvas text, so draw calls can be timed on their own
+void simBenchDisplay();
+// Mixes `samples` into out with `voices` notes held (1..4), one device
+// buffer at a time, on a mixer state of its own; live audio is not touched
+void simMixAudio(int voices, int16_t* out, int samples);
+
+// time() for the app: on the virtual clock (BOO_RECORD, BOO_REPLAY, BOO_WAV)
+// a fixed date plus virtual time, so a replay sees the same dates; else the
+// host's time()
+uint32_t simEpochSeconds();
+
+// Names the scene the overdraw counter (BOO_OVERDRAW) files the next frames
+// under; ignored when the counter is off
+void simOverdrawScene(const char* name);
+
+// Hash of the app's own state, logged and checked with every frame by
+// BOO_RECORD / BOO_REPLAY next to the framebuffer hash
+void simSetStateHash(uint32_t (*fn)());
+
 #endif
@@ -2,54 +2,83 @@
 #define PREFERENCES_H
 
 #include "Arduino.h"
-#include <map>
+#include <cstring>
 #include <string>
 
+// Stand-in for the ESP32 Preferences (NVS) API. Every namespace lives in one
+// in-memory table, loaded from a compact binary file on the first begin().
+// Puts only change memory. The table is written back in one atomic write on
+// end(), or once puts have gone quiet for a moment, so a burst of puts costs a
+// single write, the way a careful flash user would batch them. Puts that
+// would store the same value again are not counted as changes, matching NVS.
+//
+// BOO_PREFS=path picks the file and BOO_PREFS= (empty) keeps everything in
+// memory. The default is boo_prefs.bin, except under BOO_SMOKE, BOO_WAV,
+// BOO_REPLAY and BOO_RECORD, which run in memory so every run starts the same.
 class Preferences {
 public:
-    bool begin(const char * name, bool readOnly=false) { return true; }
-    void end() {}
-
-    // For this app we only need putInt/getInt/putFloat/getFloat etc if used.
-    // main.cpp currently creates 'prefs' but doesn't seem to heavily use it yet 
-    // in the code I read (it was mostly in the "Features Implemented" list but maybe not in main.cpp logic yet).
-    // Let's check main.cpp usage. 
-    // main.cpp has `Preferences prefs;` and `prefs.begin("boo", false);`
-    // but looking at the code, it doesn't actually call put/get!
-    // So empty stubs are fine for now.
-
-    size_t putChar(const char* key, int8_t value) { return 1; }
-    size_t putUChar(const char* key, uint8_t value) { return 1; }
-    size_t putShort(const char* key, int16_t value) { return 1; }
-    size_t putUShort(const char* key, uint16_t value) { return 1; }
-    size_t putInt(const char* key, int32_t value) { return 1; }
-    size_t putUInt(const char* key, uint32_t value) { return 1; }
-    size_t putLong(const char* key, int32_t value) { return 1; }
-    size_t putULong(const char* key, uint32_t value) { return 1; }
-    size_t putLong64(const char* key, int64_t value) { return 1; }
-    size_t putULong64(const char* key, uint64_t value) { return 1; }
-    size_t putFloat(const char* key, float value) { return 1; }
-    size_t putDouble(const char* key, double value) { return 1; }
-    size_t putBool(const char* key, bool value) { return 1; }
-    size_t putString(const char* key, const char* value) { return 1; }
-    size_t putString(const char* key, String value) { return 1; }
-    size_t putBytes(const char* key, const void* value, size_t len) { return 1; }
-
-    int8_t getChar(const char* key, int8_t defaultValue = 0) { return defaultValue; }
-    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return defaultValue; }
-    int16_t getShort(const char* key, int16_t defaultValue = 0) { return defaultValue; }
-    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return defaultValue; }
-    int32_t getInt(const char* key, int32_t defaultValue = 0) { return defaultValue; }
-    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return defaultValue; }
-    int32_t getLong(const char* key, int32_t defaultValue = 0) { return defaultValue; }
-    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return defaultValue; }
-    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return defaultValue; }
-    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return defaultValue; }
-    float getFloat(const char* key, float defaultValue = NAN) { return defaultValue; }
-    double getDouble(const char* key, double defaultValue = NAN) { return defaultValue; }
-    bool getBool(const char* key, bool defaultValue = false) { return defaultValue; }
-    String getString(const char* key, String defaultValue = String()) { return defaultValue; }
-    size_t getBytes(const char* key, void * buf, size_t maxLen) { return 0; }
+    Preferences() : readOnly(false), started(false) {}
+
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t getBytesLength(const char* key);
+
+    size_t putChar(const char* key, int8_t value) { return putValue(key, TYPE_I8, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putValue(key, TYPE_U8, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putValue(key, TYPE_I16, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putValue(key, TYPE_U16, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, TYPE_I32, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, TYPE_U32, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putLong64(const char* key, int64_t value) { return putValue(key, TYPE_I64, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putValue(key, TYPE_U64, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putValue(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return putValue(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value) { return putValue(key, TYPE_STR, value, strlen(value)); }
+    size_t putString(const char* key, String value) { return putValue(key, TYPE_STR, value.data(), value.size()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, TYPE_BLOB, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getAs(key, TYPE_I8, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getAs(key, TYPE_U8, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getAs(key, TYPE_I16, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getAs(key, TYPE_U16, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getAs(key, TYPE_I32, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getAs(key, TYPE_U32, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getAs(key, TYPE_I64, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getAs(key, TYPE_U64, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return getAs(key, TYPE_BLOB, defaultValue); }
+    double getDouble(const char* key, double defaultValue = NAN) { return getAs(key, TYPE_BLOB, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    String getString(const char* key, String defaultValue = String());
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    // Value types as stored; a get only sees a put of the same type
+    enum : uint8_t {
+        TYPE_I8 = 1, TYPE_U8, TYPE_I16, TYPE_U16, TYPE_I32, TYPE_U32, TYPE_I64, TYPE_U64, TYPE_STR, TYPE_BLOB
+    };
+
+    size_t putValue(const char* key, uint8_t type, const void* data, size_t len);
+    // Copies the stored value into out if it exists with this type and size
+    bool getValue(const char* key, uint8_t type, void* out, size_t len);
+
+    template <typename T>
+    T getAs(const char* key, uint8_t type, T defaultValue) {
+        T value;
+        return getValue(key, type, &value, sizeof(value)) ? value : defaultValue;
+    }
+
+    std::string ns;
+    bool readOnly;
+    bool started;
 };
 
 #endif
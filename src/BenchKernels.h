@@ -0,0 +1,18 @@
+#ifndef BOO_BENCH_KERNELS_H
+#define BOO_BENCH_KERNELS_H
+
+// Draw kernels main.cpp hands to the benchmark (src/bench_main.cpp). Each
+// run() draws into the canvas; setup(), when set, is called once first to
+// put the scene state (particles, crowd, pet) in place.
+struct BenchKernel {
+    const char* group;  // "primitive", "composite", "food" or "frame"
+    const char* name;
+    void (*setup)(int arg);
+    void (*run)(int arg);
+    int arg;
+};
+
+// Fills out[] with up to max kernels; returns how many there are in all
+int benchRenderKernels(BenchKernel* out, int max);
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef BOO_COUNTING_CANVAS_H
+#define BOO_COUNTING_CANVAS_H
+
+#include <M5Cardputer.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "BooGame.h"
+
+// The sprite the app draws into. It counts draw calls, and the pixels they
+// cover, for the performance HUD. Pixels are worked out from shape sizes
+// rather than read back, so the counts are the same on the device and in
+// the simulator. Rects are clipped to the screen, circles and triangles
+// count their area, and text counts its character cells.
+//
+// Only the calls the app makes are wrapped; they hide the M5Canvas ones of
+// the same name and pass straight through.
+class CountingCanvas : public M5Canvas {
+public:
+    struct Counts {
+        uint32_t drawCalls;
+        uint32_t pixels;
+    };
+
+    template <typename Display>
+    explicit CountingCanvas(Display* display) : M5Canvas(display), textSize(1) {
+        counts.drawCalls = 0;
+        counts.pixels = 0;
+    }
+
+    // Counts since the last take()
+    Counts take() {
+        Counts taken = counts;
+        counts.drawCalls = 0;
+        counts.pixels = 0;
+        return taken;
+    }
+
+    void fillSprite(uint16_t color) {
+        add(SCREEN_WIDTH * SCREEN_HEIGHT);
+        M5Canvas::fillSprite(color);
+    }
+
+    void fillRect(int x, int y, int w, int h, uint16_t color) {
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > SCREEN_WIDTH ? SCREEN_WIDTH : x + w;
+        int y1 = y + h > SCREEN_HEIGHT ? SCREEN_HEIGHT : y + h;
+        add(x1 > x0 && y1 > y0 ? (uint32_t)(x1 - x0) * (y1 - y0) : 0);
+        M5Canvas::fillRect(x, y, w, h, color);
+    }
+
+    void fillCircle(int x, int y, int r, uint16_t color) {
+        add((uint32_t)(2 * r + 1) * (2 * r + 1) * 201 / 256);  // pi/4 of the bounding square
+        M5Canvas::fillCircle(x, y, r, color);
+    }
+
+    void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color) {
+        long cross = (long)(x1 - x0) * (y2 - y0) - (long)(x2 - x0) * (y1 - y0);
+        add((uint32_t)(labs(cross) / 2 + 1));
+        M5Canvas::fillTriangle(x0, y0, x1, y1, x2, y2, color);
+    }
+
+    void drawLine(int x0, int y0, int x1, int y1, uint16_t color) {
+        int dx = abs(x1 - x0), dy = abs(y1 - y0);
+        add((dx > dy ? dx : dy) + 1);
+        M5Canvas::drawLine(x0, y0, x1, y1, color);
+    }
+
+    void setTextSize(int size) {
+        textSize = size;
+        M5Canvas::setTextSize(size);
+    }
+
+    // Forwarded as is, so each argument type reaches the same overload it
+    // would without the wrapper
+    template <typename T>
+    void print(T value) {
+        add((uint32_t)textLength(value) * 6 * 8 * textSize * textSize);
+        M5Canvas::print(value);
+    }
+
+    template <typename... Args>
+    void printf(const char* format, Args... args) {
+        char text[128];
+        snprintf(text, sizeof(text), format, args...);
+        print((const char*)text);
+    }
+
+private:
+    void add(uint32_t pixels) {
+        counts.drawCalls++;
+        counts.pixels += pixels;
+    }
+
+    static int textLength(const char* s) { return (int)strlen(s); }
+    static int textLength(char) { return 1; }
+    static int textLength(int n) { return snprintf(nullptr, 0, "%d", n); }
+
+    Counts counts;
+    int textSize;
+};
+
+#endif
@@ -1,18 +1,31 @@
 #ifdef SIMULATOR
 
 #include "M5Cardputer.h"
+#include "Preferences.h"
 #include <SDL2/SDL.h>
 #include <iostream>
+#include <atomic>
 #include <chrono>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <random>
+#include <thread>
+#include <ctime>
+#include <cstdlib>
 #include <vector>
 #include <stdarg.h>
 
 extern void setup();
 extern void loop();
 
+#ifndef BOO_BENCH  // The benchmark brings its own main (src/bench_main.cpp)
+static void print_sim_report();
+
 int main(int argc, char* argv[]) {
     setvbuf(stdout, NULL, _IOLBF, 0); // Line buffering
     printf("Sim: Starting...\n");
+    atexit(print_sim_report);
     setup();
     printf("Sim: Setup done. Entering loop...\n");
     while (true) {
@@ -20,6 +33,7 @@ int main(int argc, char* argv[]) {
     }
     return 0;
 }
+#endif
 
 // ================= Globals =================
 M5Cardputer_Class M5Cardputer;
@@ -35,24 +49,178 @@ static uint32_t* pixelBuffer = nullptr; // 240x135 buffer (ARGB8888)
 static int screenW = 240;
 static int screenH = 135;
 static int scale = 3; // Scale up for visibility
+static bool lcdEcho = true; // Canvas text is echoed to stdout as "LCD: ..."
 
 // Audio State
+// Square waves from 32-bit phase accumulators (DDS): one full cycle is 2^32,
+// so the per-sample step is computed once per note in integer math. Notes
+// start and end on exact sample positions instead of buffer boundaries.
+//
+// Like M5Unified, sounds are addressed by channel (0-7). Each playing sound
+// takes one voice from a small pool; when the pool is full a new sound steals
+// the oldest voice on the lowest channel not above its own, so higher
+// channels (sound effects) win over lower ones (music).
+static const int audioSampleRate = 44100;
+static int audioBufferSamples = 2048; // BOO_AUDIO_SAMPLES, power of two 256..4096
+static const int audioChannels = 8;
+static const int audioVoices = 4;
+static const int audioMaxSamples = 4096;
+static const int32_t voiceAmplitude = 3000; // At full master and channel volume
+
+struct Voice {
+    int channel = -1;               // -1 = free
+    uint32_t serial = 0;            // Start order, for oldest-first stealing
+    uint32_t phase = 0;
+    uint32_t phaseStep = 0;         // frequency * 2^32 / sampleRate
+    uint64_t startSample = 0;       // Note on, in samples since the device started
+    uint64_t endSample = 0;         // Note off (exclusive)
+};
+
 struct AudioState {
-    int frequency = 0;
-    unsigned long endTime = 0;
-    uint8_t volume = 128; // 0-255
-    double phase = 0.0;
+    Voice voices[audioVoices];
+    uint8_t volume = 128; // 0-255, master
+    uint8_t channelVolume[audioChannels] = {255, 255, 255, 255, 255, 255, 255, 255};
+    uint32_t nextSerial = 1;
+    uint64_t renderedSamples = 0;   // Next sample the callback will produce
+
+    // Mixer accounting
+    unsigned long steals = 0;       // Sounds that cut off another voice
+    unsigned long dropped = 0;      // Sounds with no voice they were allowed to take
+    unsigned long clipped = 0;      // Samples saturated by the mixer
 };
 static AudioState audioState;
 static SDL_AudioDeviceID audioDevice;
 
-// Input State
-static std::vector<char> pendingKeys; // Accumulates keys during delay/pump_events
-static std::vector<char> currentKeys; // Exposed to the app for the current frame
-static bool keyChanged = false;
+// Callback timing. Only the callback writes these; each field is an atomic
+// so the main loop can read a consistent value at any time without a lock.
+struct AudioStatsBlock {
+    std::atomic<unsigned long> buffers{0};
+    std::atomic<unsigned long long> samples{0};
+    std::atomic<unsigned long long> callbackUsTotal{0};
+    std::atomic<unsigned long> callbackUsMax{0};
+    std::atomic<unsigned long long> intervalUsTotal{0};
+    std::atomic<unsigned long> intervalUsMin{ULONG_MAX};
+    std::atomic<unsigned long> intervalUsMax{0};
+    std::atomic<unsigned long> underruns{0};
+    std::atomic<unsigned long> lastUnderrunMs{0};
+    std::atomic<unsigned long long> lastCallbackUs{0};
+};
+static AudioStatsBlock audioStats;
+
+// Speaker calls are turned into commands on a single-producer single-consumer
+// ring. The callback drains it at the start of every buffer, so the game
+// thread never waits for the mixer and the mixer state has a single owner.
+enum AudioCommandType : uint8_t { CMD_TONE, CMD_STOP_ALL, CMD_STOP_CHANNEL, CMD_VOLUME, CMD_CHANNEL_VOLUME };
+
+struct AudioCommand {
+    AudioCommandType type;
+    int8_t channel;                 // -1 = pick a free channel (tone)
+    bool stopCurrent;
+    uint8_t volume;
+    uint32_t phaseStep;
+    uint32_t duration;              // ms, UINT32_MAX = until stopped
+    uint64_t atSample;              // When the game thread issued it
+};
+
+static const uint32_t audioQueueSize = 64;  // Power of two
+
+struct AudioQueue {
+    AudioCommand slots[audioQueueSize];
+    std::atomic<uint32_t> head{0};  // Written only by the game thread
+    std::atomic<uint32_t> tail{0};  // Written only by the audio callback
+
+    // Game thread accounting
+    unsigned long sent = 0;
+    unsigned long full = 0;         // Commands dropped because the ring was full
+    uint32_t maxDepth = 0;
+    unsigned long long sendNsTotal = 0;
+    unsigned long sendNsMax = 0;
+
+    // Callback accounting
+    uint32_t maxDrained = 0;        // Most commands applied before one buffer
+};
+static AudioQueue audioQueue;
+static unsigned long long audioStartUs = 0;
+// The callback's sample clock against micros(): the sample the mixer will be
+// at when micros() is 0, republished by every callback. Notes are placed on
+// it, so a stalled callback or an underrun moves them with the audio instead
+// of leaving them late for good. LLONG_MIN until the first callback.
+static std::atomic<long long> audioSampleOrigin{LLONG_MIN};
+
+// Offline capture (BOO_WAV=path): no window and no audio device. The clock
+// only moves inside delay(), and the synth is rendered to a WAV file in step
+// with it, so a run is deterministic and much faster than real time.
+static bool virtualClock = false;
+static unsigned long long virtualUs = 0;
+static FILE* wavFile = nullptr;
+static const char* wavPath = nullptr;
+static uint32_t wavDataBytes = 0;
+
+// Record / replay (BOO_RECORD=path, BOO_REPLAY=path): key events are logged
+// against the update() they were delivered on, plus the RNG seed and a hash
+// of every presented frame. Both run on the virtual clock, so a replay makes
+// the same frames bit for bit and stops at the first one that differs.
+struct ReplayKey { unsigned long update; KeyEvent event; };
+struct ReplayFrame { uint32_t pixels; uint32_t state; };
+static FILE* recordFile = nullptr;
+static const char* replayPath = nullptr;
+static std::vector<ReplayKey> replayKeys;
+static std::vector<ReplayFrame> replayFrames;
+static size_t replayNextKey = 0;
+static unsigned long replayEndUpdate = 0;
+static bool replaySeeded = false;
+static long replaySeed = 0;
+static unsigned long updateCount = 0;
+static unsigned long frameCount = 0;
+static uint32_t (*stateHashFn)() = nullptr;
+static std::chrono::steady_clock::time_point replayStart;
 
 // Time State
 static auto startTime = std::chrono::steady_clock::now();
+// millis()/micros() count from process start, as the device counts from reset
+static const auto clockStart = std::chrono::steady_clock::now();
+
+// Host CPU accounting: process CPU time (all threads) against wall time
+static std::clock_t startCpu = std::clock();
+static unsigned long delayCalls = 0;
+static unsigned long delayWakeups = 0;  // Early wake-ups caused by input events
+static long long delayLateUsTotal = 0;  // Sum of (wake time - deadline)
+static long long delayLateUsMax = 0;
+
+// Key-to-photon latency: key presses the app has been handed by update()
+// that no presented frame has shown yet, and how long they ended up waiting
+static const int latencyBuckets = 9;
+static const unsigned long latencyBucketMs[latencyBuckets - 1] = {4, 8, 16, 33, 50, 66, 100, 200};
+static KeyEvent keysAwaitingPhoton[KeyList::CAPACITY];
+static int keysAwaiting = 0;
+static bool latencyLog = false;  // BOO_LATENCY_LOG=1 prints every sample
+static unsigned long latencyHist[latencyBuckets];
+static unsigned long latencyCount = 0;
+static unsigned long long latencyUsTotal = 0;
+static unsigned long latencyUsMax = 0;
+
+// Overdraw (BOO_OVERDRAW=1, or =heat to show it): how many times each pixel
+// was written since the last present, tallied per scene when a frame is
+// presented. Null when off, so the draw paths pay one test.
+struct OverdrawScene {
+    std::string name;
+    unsigned long frames = 0;
+    unsigned long long writes = 0;      // Pixel writes, all frames
+    unsigned long long covered = 0;     // Pixels written at least once, all frames
+    unsigned long writesMax = 0;        // Most writes in one frame
+    uint8_t depthMax = 0;               // Most writes to one pixel in one frame
+};
+static uint8_t* overdrawDepth = nullptr;    // Saturates at 255
+static uint32_t* overdrawHeatBuffer = nullptr; // Shown instead of the frame
+static unsigned long overdrawWrites = 0;    // This frame
+static std::vector<OverdrawScene> overdrawScenes;
+static int overdrawScene = -1;
+
+static inline void overdraw_note(int index) {
+    if (!overdrawDepth) return;
+    overdrawWrites++;
+    if (overdrawDepth[index] < 255) overdrawDepth[index]++;
+}
 
 // Font Data (5x7 basic ASCII)
 static const unsigned char font5x7[] = {
@@ -126,71 +294,743 @@ extern void setup();
 
 // ================= Arduino Mocks =================
 
+// Time the event was queued by SDL, on our micros() clock
+static unsigned long event_time_us(const SDL_Event& e) {
+    unsigned long now = micros();
+    if (virtualClock) return now;
+    Uint32 ageMs = SDL_GetTicks() - e.key.timestamp;
+    if (ageMs > 1000) return now;  // Clock skew or a stale event: don't trust it
+    return now - ageMs * 1000UL;
+}
+
+void handle_event(const SDL_Event& e) {
+    if (e.type == SDL_QUIT) exit(0);
+    if (replayPath) return;  // Input comes from the file
+
+    if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) {
+        bool down = e.type == SDL_KEYDOWN;
+        if (down && e.key.repeat) return;  // Held keys stay down; repeats are not changes
+
+        char key = 0;
+        if (e.key.keysym.sym >= SDLK_a && e.key.keysym.sym <= SDLK_z) key = 'a' + (e.key.keysym.sym - SDLK_a);
+        if (e.key.keysym.sym >= SDLK_0 && e.key.keysym.sym <= SDLK_9) key = '0' + (e.key.keysym.sym - SDLK_0);
+
+        // Volume Controls
+        if (e.key.keysym.sym == SDLK_MINUS) key = '-';
+        if (e.key.keysym.sym == SDLK_EQUALS) key = '=';
+
+        unsigned long us = event_time_us(e);
+        if (key != 0) M5Cardputer.Keyboard.pushEvent({key, down, us});
+
+        // Shift+1 also reports '!'; its release goes with the 1 key
+        if (e.key.keysym.sym == SDLK_1 && (!down || (e.key.keysym.mod & KMOD_SHIFT))) {
+            M5Cardputer.Keyboard.pushEvent({'!', down, us});
+        }
+    }
+}
+
 // Helper to keep UI responsive
 void pump_events() {
+    if (!sdl_initialized) return;
     SDL_Event e;
     while (SDL_PollEvent(&e) != 0) {
-        if (e.type == SDL_QUIT) exit(0);
-        
-        if (e.type == SDL_KEYDOWN) {
-            char key = 0;
-            if (e.key.keysym.sym >= SDLK_a && e.key.keysym.sym <= SDLK_z) key = 'a' + (e.key.keysym.sym - SDLK_a);
-            if (e.key.keysym.sym >= SDLK_0 && e.key.keysym.sym <= SDLK_9) key = '0' + (e.key.keysym.sym - SDLK_0);
-            
-            // Volume Controls
-            if (e.key.keysym.sym == SDLK_MINUS) key = '-';
-            if (e.key.keysym.sym == SDLK_EQUALS) key = '=';
-
-            if (key != 0) pendingKeys.push_back(key);
-            
-            if (e.key.keysym.sym == SDLK_1 && (e.key.keysym.mod & KMOD_SHIFT)) {
-                 pendingKeys.push_back('!');
-            }
-        }
+        handle_event(e);
     }
 }
 
 unsigned long millis() {
+    if (virtualClock) return (unsigned long)(virtualUs / 1000);
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - clockStart).count();
+}
+
+unsigned long micros() {
+    if (virtualClock) return (unsigned long)virtualUs;
     auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now - clockStart).count();
+}
+
+// Reproducible runs start their calendar at 2026-01-01 00:00 UTC
+static const uint32_t virtualEpochSeconds = 1767225600;
+
+uint32_t simEpochSeconds() {
+    if (virtualClock) return virtualEpochSeconds + (uint32_t)(virtualUs / 1000000);
+    return (uint32_t)time(nullptr);
+}
+
+// Sample position the game thread is "at" right now. Audio is produced one
+// buffer ahead of playback, so a note requested now lands that far out: at
+// or after the first sample of the next buffer the callback renders.
+static uint64_t audio_sample_now() {
+    if (virtualClock) return virtualUs * audioSampleRate / 1000000;
+    long long us = (long long)micros();
+    long long origin = audioSampleOrigin.load(std::memory_order_acquire);
+    if (origin == LLONG_MIN) {
+        // No callback yet: count from when the device was opened
+        return (uint64_t)(us - (long long)audioStartUs) * audioSampleRate / 1000000 + audioBufferSamples;
+    }
+    long long sample = origin + us * audioSampleRate / 1000000;
+    return sample > 0 ? (uint64_t)sample : 0;
+}
+
+static uint64_t ms_to_samples(uint32_t ms) {
+    return (uint64_t)ms * audioSampleRate / 1000;
+}
+
+// Mixes every sounding voice into out[0..length) and advances the sample
+// clock. Voices are summed into 32-bit accumulators, then saturated to 16 bits.
+static void audio_render(AudioState* state, int16_t* out, int length) {
+    int32_t mix[audioMaxSamples];
+    for (int i = 0; i < length; i++) mix[i] = 0;
+
+    uint64_t first = state->renderedSamples;
+    uint64_t last = first + length;
+
+    for (int v = 0; v < audioVoices; v++) {
+        Voice& voice = state->voices[v];
+        if (voice.channel < 0) continue;
+        if (voice.endSample <= first) {
+            voice.channel = -1; // Finished
+            voice.phase = 0;
+            continue;
+        }
+
+        // A note scheduled before this buffer (late request) keeps its length
+        if (voice.startSample < first) {
+            if (voice.endSample != UINT64_MAX) voice.endSample = first + (voice.endSample - voice.startSample);
+            voice.startSample = first;
+        }
+        if (voice.startSample >= last) continue;
+
+        int begin = (int)(voice.startSample - first);
+        int end = voice.endSample < last ? (int)(voice.endSample - first) : length;
+        int32_t amplitude = voiceAmplitude * state->volume * state->channelVolume[voice.channel] / (255 * 255);
+        uint32_t phase = voice.phase;
+        uint32_t step = voice.phaseStep;
+        for (int i = begin; i < end; i++) {
+            mix[i] += (phase < 0x80000000u) ? amplitude : -amplitude;
+            phase += step;
+        }
+        voice.phase = phase;
+    }
+
+    for (int i = 0; i < length; i++) {
+        int32_t sample = mix[i];
+        if (sample > INT16_MAX) { sample = INT16_MAX; state->clipped++; }
+        else if (sample < INT16_MIN) { sample = INT16_MIN; state->clipped++; }
+        out[i] = (int16_t)sample;
+    }
+    state->renderedSamples = last;
+}
+
+static Voice* claim_voice(AudioState* state, int channel, bool stopCurrent, uint64_t now);
+
+// Applies one Speaker command to the mixer state. Runs on the thread that
+// owns the mixer: the callback, or the caller when there is no device.
+static void audio_apply(AudioState* state, const AudioCommand& cmd) {
+    switch (cmd.type) {
+        case CMD_TONE: {
+            int channel = cmd.channel;
+            if (channel < 0) {
+                // Auto-select: the first channel with nothing playing
+                channel = 0;
+                for (int c = 0; c < audioChannels; c++) {
+                    bool busy = false;
+                    for (int v = 0; v < audioVoices; v++) {
+                        const Voice& voice = state->voices[v];
+                        if (voice.channel == c && voice.endSample > cmd.atSample) busy = true;
+                    }
+                    if (!busy) { channel = c; break; }
+                }
+            }
+            Voice* voice = claim_voice(state, channel, cmd.stopCurrent, cmd.atSample);
+            if (voice) {
+                voice->channel = channel;
+                voice->serial = state->nextSerial++;
+                voice->phase = 0;
+                voice->phaseStep = cmd.phaseStep;
+                voice->startSample = cmd.atSample;
+                voice->endSample = cmd.duration == UINT32_MAX ? UINT64_MAX : cmd.atSample + ms_to_samples(cmd.duration);
+            }
+            break;
+        }
+        case CMD_STOP_ALL:
+            for (int v = 0; v < audioVoices; v++) state->voices[v].channel = -1;
+            break;
+        case CMD_STOP_CHANNEL:
+            for (int v = 0; v < audioVoices; v++) {
+                if (state->voices[v].channel == cmd.channel) state->voices[v].channel = -1;
+            }
+            break;
+        case CMD_VOLUME:
+            state->volume = cmd.volume;
+            break;
+        case CMD_CHANNEL_VOLUME:
+            state->channelVolume[cmd.channel] = cmd.volume;
+            break;
+    }
+}
+
+// Consumer side of the command ring
+static void audio_drain(AudioState* state) {
+    uint32_t tail = audioQueue.tail.load(std::memory_order_relaxed);
+    uint32_t head = audioQueue.head.load(std::memory_order_acquire);
+    if (head - tail > audioQueue.maxDrained) audioQueue.maxDrained = head - tail;
+    for (; tail != head; tail++) {
+        audio_apply(state, audioQueue.slots[tail & (audioQueueSize - 1)]);
+    }
+    audioQueue.tail.store(tail, std::memory_order_release);
+}
+
+// Producer side. Without a device nothing else touches the mixer, so the
+// command is applied on the spot.
+static void audio_send(const AudioCommand& cmd) {
+    if (audioDevice == 0) {
+        audio_apply(&audioState, cmd);
+        return;
+    }
+
+    auto sendStart = std::chrono::steady_clock::now();
+    uint32_t head = audioQueue.head.load(std::memory_order_relaxed);
+    uint32_t depth = head - audioQueue.tail.load(std::memory_order_acquire);
+    if (depth >= audioQueueSize) {
+        audioQueue.full++;
+    } else {
+        audioQueue.slots[head & (audioQueueSize - 1)] = cmd;
+        audioQueue.head.store(head + 1, std::memory_order_release);
+        audioQueue.sent++;
+        if (depth + 1 > audioQueue.maxDepth) audioQueue.maxDepth = depth + 1;
+    }
+    unsigned long ns = (unsigned long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - sendStart).count();
+    audioQueue.sendNsTotal += ns;
+    if (ns > audioQueue.sendNsMax) audioQueue.sendNsMax = ns;
+}
+
+// Single-writer update; relaxed atomics are enough for counters
+template <typename T>
+static void stat_add(std::atomic<T>& stat, T value) {
+    stat.store(stat.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+template <typename T>
+static void stat_max(std::atomic<T>& stat, T value) {
+    if (value > stat.load(std::memory_order_relaxed)) stat.store(value, std::memory_order_relaxed);
+}
+
+template <typename T>
+static void stat_min(std::atomic<T>& stat, T value) {
+    if (value < stat.load(std::memory_order_relaxed)) stat.store(value, std::memory_order_relaxed);
 }
 
 // Audio Callback
 void audio_callback(void* userdata, Uint8* stream, int len) {
+    auto callbackStart = std::chrono::steady_clock::now();
     AudioState* state = (AudioState*)userdata;
     int16_t* buffer = (int16_t*)stream;
     int length = len / 2; // 16-bit samples
 
-    unsigned long now = millis();
-    
-    for (int i = 0; i < length; i++) {
-        if (state->frequency > 0 && (state->endTime == 0 || now < state->endTime)) {
-            // Square wave generation
-            // Sample rate 44100
-            double sampleRate = 44100.0;
-            double samplesPerCycle = sampleRate / state->frequency;
-            
-            // Toggle based on phase
-            state->phase += 1.0;
-            if (state->phase >= samplesPerCycle) state->phase -= samplesPerCycle;
-            
-            int16_t sampleValue = (state->phase < samplesPerCycle / 2.0) ? 3000 : -3000;
-            
-            // Apply volume (simple scaling)
-            buffer[i] = (sampleValue * state->volume) / 255;
-        } else {
-            buffer[i] = 0;
-            state->phase = 0; // Reset phase on silence
+    // A callback later than one buffer period plus half means the device
+    // played out everything we gave it before asking again
+    unsigned long long nowUs = micros();
+    unsigned long long periodUs = (unsigned long long)length * 1000000 / audioSampleRate;
+    unsigned long long lastUs = audioStats.lastCallbackUs.load(std::memory_order_relaxed);
+    if (lastUs != 0) {
+        unsigned long intervalUs = (unsigned long)(nowUs - lastUs);
+        stat_add(audioStats.intervalUsTotal, (unsigned long long)intervalUs);
+        stat_min(audioStats.intervalUsMin, intervalUs);
+        stat_max(audioStats.intervalUsMax, intervalUs);
+        if (intervalUs > periodUs + periodUs / 2) {
+            stat_add(audioStats.underruns, 1UL);
+            audioStats.lastUnderrunMs.store(millis(), std::memory_order_relaxed);
+        }
+    }
+    audioStats.lastCallbackUs.store(nowUs, std::memory_order_relaxed);
+
+    audio_drain(state);
+    for (int done = 0; done < length; done += audioMaxSamples) {
+        audio_render(state, buffer + done, min(length - done, audioMaxSamples));
+    }
+    audioSampleOrigin.store((long long)state->renderedSamples - (long long)nowUs * audioSampleRate / 1000000,
+                            std::memory_order_release);
+
+    unsigned long callbackUs = (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - callbackStart).count();
+    stat_add(audioStats.callbackUsTotal, (unsigned long long)callbackUs);
+    stat_max(audioStats.callbackUsMax, callbackUs);
+    stat_add(audioStats.samples, (unsigned long long)length);
+    stat_add(audioStats.buffers, 1UL);  // Last, so readers never see a buffer without its timing
+}
+
+// ================= Offline Capture =================
+
+static void wav_put32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+static void wav_put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF;
+}
+
+// 44-byte canonical header for 16-bit mono PCM
+static void wav_write_header(FILE* f, uint32_t dataBytes) {
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    wav_put32(h + 4, 36 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    wav_put32(h + 16, 16);
+    wav_put16(h + 20, 1);  // PCM
+    wav_put16(h + 22, 1);  // Mono
+    wav_put32(h + 24, audioSampleRate);
+    wav_put32(h + 28, audioSampleRate * 2);
+    wav_put16(h + 32, 2);
+    wav_put16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    wav_put32(h + 40, dataBytes);
+    fseek(f, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+static void capture_finish() {
+    if (!wavFile) return;
+    wav_write_header(wavFile, wavDataBytes);
+    fclose(wavFile);
+    wavFile = nullptr;
+    printf("Sim: wrote %u samples (%.2fs) to %s\n", wavDataBytes / 2,
+           wavDataBytes / 2.0 / audioSampleRate, wavPath);
+}
+
+static bool capture_start(const char* path) {
+    wavFile = fopen(path, "wb");
+    if (!wavFile) {
+        printf("Sim: cannot open %s for audio capture\n", path);
+        return false;
+    }
+    wavPath = path;
+    wav_write_header(wavFile, 0);
+    atexit(capture_finish);
+    return true;
+}
+
+// Moves the virtual clock forward, rendering the audio that plays meanwhile
+static void virtual_advance(unsigned long long us) {
+    virtualUs += us;
+    if (!wavFile) return;
+
+    uint64_t target = audio_sample_now();
+    int16_t buffer[audioMaxSamples];
+    while (audioState.renderedSamples < target) {
+        int n = (int)min(target - audioState.renderedSamples, (uint64_t)audioMaxSamples);
+        audio_render(&audioState, buffer, n);
+        uint8_t bytes[audioMaxSamples * 2];
+        for (int i = 0; i < n; i++) wav_put16(bytes + i * 2, (uint16_t)buffer[i]);
+        fwrite(bytes, 2, n, wavFile);
+        wavDataBytes += n * 2;
+    }
+}
+
+// ================= Record / Replay =================
+
+// FNV-1a, 32 bit
+static uint32_t hash_bytes(const void* data, size_t len, uint32_t h = 2166136261u) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void simSetStateHash(uint32_t (*fn)()) {
+    stateHashFn = fn;
+}
+
+static void record_finish() {
+    if (!recordFile) return;
+    fprintf(recordFile, "end %lu %lu\n", updateCount, frameCount);
+    fclose(recordFile);
+    recordFile = nullptr;
+    printf("Sim: recorded %lu updates, %lu frames\n", updateCount, frameCount);
+}
+
+static bool record_start(const char* path) {
+    recordFile = fopen(path, "w");
+    if (!recordFile) {
+        printf("Sim: cannot open %s for recording\n", path);
+        return false;
+    }
+    fprintf(recordFile, "boo-replay 1\n");
+    atexit(record_finish);
+    return true;
+}
+
+// Reads a recording made with BOO_RECORD. Lines:
+//   seed <n>                          randomSeed() argument
+//   key <update> <d|u> <char code>    delivered by that update() call
+//   frame <n> <pixel hash> <state hash>
+//   end <updates> <frames>
+static bool replay_load(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        printf("Sim: cannot open replay %s\n", path);
+        return false;
+    }
+    char line[128];
+    if (!fgets(line, sizeof(line), f) || strncmp(line, "boo-replay 1", 12) != 0) {
+        printf("Sim: %s is not a replay file\n", path);
+        fclose(f);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long n;
+        char dir;
+        int code;
+        unsigned int pixels, state;
+        long seed;
+        if (sscanf(line, "key %lu %c %d", &n, &dir, &code) == 3) {
+            replayKeys.push_back({n, {(char)code, dir == 'd', 0}});
+        } else if (sscanf(line, "frame %lu %x %x", &n, &pixels, &state) == 3) {
+            replayFrames.push_back({pixels, state});
+        } else if (sscanf(line, "end %lu", &n) == 1) {
+            replayEndUpdate = n;
+        } else if (sscanf(line, "seed %ld", &seed) == 1) {
+            replaySeed = seed;
+            replaySeeded = true;
+        }
+    }
+    fclose(f);
+    replayPath = path;
+    return true;
+}
+
+// Feeds the recorded events due on this update()
+static void replay_keys() {
+    while (replayNextKey < replayKeys.size() && replayKeys[replayNextKey].update == updateCount) {
+        KeyEvent e = replayKeys[replayNextKey++].event;
+        e.us = micros();
+        M5Cardputer.Keyboard.pushEvent(e);
+    }
+}
+
+// Logs or checks the frame that was just presented
+static void replay_frame() {
+    uint32_t pixels = pixelBuffer ? hash_bytes(pixelBuffer, screenW * screenH * sizeof(uint32_t)) : 0;
+    uint32_t state = stateHashFn ? stateHashFn() : 0;
+    frameCount++;
+
+    if (recordFile) {
+        fprintf(recordFile, "frame %lu %08x %08x\n", frameCount, pixels, state);
+        return;
+    }
+    if (!replayPath) return;
+
+    if (frameCount > replayFrames.size()) {
+        printf("Sim: replay ran past the %zu recorded frames\n", replayFrames.size());
+        exit(2);
+    }
+    const ReplayFrame& expect = replayFrames[frameCount - 1];
+    if (expect.pixels != pixels || expect.state != state) {
+        printf("Sim: replay diverged at frame %lu (update %lu): %s%s%s\n", frameCount, updateCount,
+               expect.pixels != pixels ? "framebuffer" : "",
+               expect.pixels != pixels && expect.state != state ? " and " : "",
+               expect.state != state ? "game state" : "");
+        exit(2);
+    }
+    if (frameCount == replayFrames.size()) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+        printf("Sim: replay matched %lu frames (%lu updates, %.1fs of play) in %.3fs, %.0f frames/s\n",
+               frameCount, updateCount, virtualUs / 1e6, secs, frameCount / secs);
+        exit(0);
+    }
+}
+
+// ================= Preferences =================
+// One table for every namespace, keyed "namespace\0key" so the file comes
+// out in a stable order. File layout, integers little-endian:
+//   "BOOP" u8 version, u16 entry count
+//   per entry: u8 type, u8 namespace length, namespace, u8 key length, key,
+//              u16 value length, value
+//   u32 FNV-1a of everything before it
+
+struct PrefsEntry {
+    uint8_t type;
+    std::string value;
+};
+
+static const uint8_t prefsVersion = 1;
+static const size_t prefsMaxName = 15;              // NVS limit for keys and namespaces
+static const unsigned long prefsQuietMs = 1000;     // Commit once puts pause this long
+static const unsigned long prefsMaxDirtyMs = 5000;  // ...or this long after the first one
+
+static std::map<std::string, PrefsEntry> prefsTable;
+static bool prefsLoaded = false;
+static std::string prefsPath;                       // Empty: memory only
+static bool prefsDirty = false;
+static unsigned long prefsFirstDirtyMs = 0;
+static unsigned long prefsLastPutMs = 0;
+static SimPrefsStats prefsStats = {};
+static unsigned long long prefsCommitUsTotal = 0;
+
+static void prefs_put16(std::string& out, uint16_t v) {
+    out.push_back((char)(v & 0xFF));
+    out.push_back((char)(v >> 8));
+}
+
+static std::string prefs_encode() {
+    std::string out("BOOP", 4);
+    out.push_back((char)prefsVersion);
+    prefs_put16(out, (uint16_t)prefsTable.size());
+    for (const auto& item : prefsTable) {
+        size_t split = item.first.find('\0');
+        out.push_back((char)item.second.type);
+        out.push_back((char)split);
+        out.append(item.first, 0, split);
+        out.push_back((char)(item.first.size() - split - 1));
+        out.append(item.first, split + 1, std::string::npos);
+        prefs_put16(out, (uint16_t)item.second.value.size());
+        out.append(item.second.value);
+    }
+    uint32_t sum = hash_bytes(out.data(), out.size());
+    for (int i = 0; i < 4; i++) out.push_back((char)(sum >> (8 * i)));
+    return out;
+}
+
+static bool prefs_decode(const std::string& data) {
+    const uint8_t* p = (const uint8_t*)data.data();
+    size_t size = data.size();
+    if (size < 11 || memcmp(p, "BOOP", 4) != 0 || p[4] != prefsVersion) return false;
+    uint32_t sum = p[size - 4] | (p[size - 3] << 8) | (p[size - 2] << 16) | ((uint32_t)p[size - 1] << 24);
+    if (hash_bytes(p, size - 4) != sum) return false;
+
+    size_t pos = 5;
+    size_t end = size - 4;
+    unsigned count = p[pos] | (p[pos + 1] << 8);
+    pos += 2;
+    std::map<std::string, PrefsEntry> table;
+    for (unsigned i = 0; i < count; i++) {
+        if (pos + 2 > end) return false;
+        uint8_t type = p[pos++];
+        size_t nsLen = p[pos++];
+        if (pos + nsLen + 1 > end) return false;
+        std::string key(data, pos, nsLen);
+        pos += nsLen;
+        size_t keyLen = p[pos++];
+        if (pos + keyLen + 2 > end) return false;
+        key.push_back('\0');
+        key.append(data, pos, keyLen);
+        pos += keyLen;
+        size_t valueLen = p[pos] | (p[pos + 1] << 8);
+        pos += 2;
+        if (pos + valueLen > end) return false;
+        table[key] = PrefsEntry{type, std::string(data, pos, valueLen)};
+        pos += valueLen;
+    }
+    if (pos != end) return false;
+    prefsTable.swap(table);
+    return true;
+}
+
+// Writes the whole table to a temporary file and renames it over the old
+// one, so a crash mid-write leaves the previous commit intact
+// Stays dirty when the write fails; the next try waits out a fresh quiet
+// period rather than coming on every poll
+static void prefs_commit() {
+    if (!prefsDirty) return;
+    if (prefsPath.empty()) {
+        prefsDirty = false;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string data = prefs_encode();
+    std::string tmp = prefsPath + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    bool ok = f && fwrite(data.data(), 1, data.size(), f) == data.size();
+    if (f) ok = fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), prefsPath.c_str()) != 0) {
+        printf("Sim: cannot write preferences to %s\n", prefsPath.c_str());
+        prefsFirstDirtyMs = prefsLastPutMs = millis();
+        return;
+    }
+    prefsDirty = false;
+    unsigned long us = (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    prefsStats.commits++;
+    prefsStats.bytesWritten += data.size();
+    prefsStats.fileBytes = data.size();
+    prefsCommitUsTotal += us;
+    if (us > prefsStats.commitUsMax) prefsStats.commitUsMax = us;
+}
+
+static void prefs_load() {
+    if (prefsLoaded) return;
+    prefsLoaded = true;
+    atexit(prefs_commit);
+
+    const char* pathEnv = std::getenv("BOO_PREFS");
+    const char* reproducible[] = {"BOO_SMOKE", "BOO_WAV", "BOO_REPLAY", "BOO_RECORD"};
+    if (pathEnv) {
+        prefsPath = pathEnv;
+    } else {
+        prefsPath = "boo_prefs.bin";
+        for (const char* name : reproducible) {
+            const char* value = std::getenv(name);
+            if (value && value[0] != '\0') prefsPath.clear();
         }
     }
+    if (prefsPath.empty()) return;
+
+    FILE* f = fopen(prefsPath.c_str(), "rb");
+    if (!f) return;  // First run
+    std::string data;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    fclose(f);
+    if (!prefs_decode(data)) {
+        printf("Sim: ignoring damaged preferences file %s\n", prefsPath.c_str());
+        return;
+    }
+    prefsStats.fileBytes = data.size();
+}
+
+static void prefs_changed() {
+    unsigned long now = millis();
+    if (!prefsDirty) prefsFirstDirtyMs = now;
+    prefsDirty = true;
+    prefsLastPutMs = now;
+}
+
+// Called from update() and delay(): commits once puts have settled
+static void prefs_poll() {
+    if (!prefsDirty) return;
+    unsigned long now = millis();
+    if (now - prefsLastPutMs >= prefsQuietMs || now - prefsFirstDirtyMs >= prefsMaxDirtyMs) prefs_commit();
+}
+
+static bool prefs_valid_name(const char* name) {
+    return name && name[0] != '\0' && strlen(name) <= prefsMaxName;
+}
+
+bool Preferences::begin(const char* name, bool ro) {
+    if (started || !prefs_valid_name(name)) return false;
+    prefs_load();
+    ns = name;
+    readOnly = ro;
+    started = true;
+    return true;
+}
+
+void Preferences::end() {
+    if (!started) return;
+    started = false;
+    prefs_commit();
+}
+
+bool Preferences::clear() {
+    if (!started || readOnly) return false;
+    std::string prefix = ns + '\0';
+    auto it = prefsTable.lower_bound(prefix);
+    bool any = false;
+    while (it != prefsTable.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        it = prefsTable.erase(it);
+        any = true;
+    }
+    if (any) prefs_changed();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!started || readOnly || !key) return false;
+    if (prefsTable.erase(ns + '\0' + key) == 0) return false;
+    prefs_changed();
+    return true;
+}
+
+bool Preferences::isKey(const char* key) {
+    return started && key && prefsTable.count(ns + '\0' + key) > 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!started || !key) return 0;
+    auto it = prefsTable.find(ns + '\0' + key);
+    return it != prefsTable.end() && it->second.type == TYPE_BLOB ? it->second.value.size() : 0;
+}
+
+size_t Preferences::putValue(const char* key, uint8_t type, const void* data, size_t len) {
+    if (!started || readOnly || !prefs_valid_name(key) || len > 0xFFFF) return 0;
+    prefsStats.puts++;
+    PrefsEntry& entry = prefsTable[ns + '\0' + key];
+    std::string value((const char*)data, len);
+    if (entry.type == type && entry.value == value) {
+        prefsStats.putsUnchanged++;
+        return len;
+    }
+    entry.type = type;
+    entry.value.swap(value);
+    prefs_changed();
+    return len;
+}
+
+bool Preferences::getValue(const char* key, uint8_t type, void* out, size_t len) {
+    if (!started || !key) return false;
+    auto it = prefsTable.find(ns + '\0' + key);
+    if (it == prefsTable.end() || it->second.type != type || it->second.value.size() != len) return false;
+    memcpy(out, it->second.value.data(), len);
+    return true;
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+    if (!started || !key) return defaultValue;
+    auto it = prefsTable.find(ns + '\0' + key);
+    if (it == prefsTable.end() || it->second.type != TYPE_STR) return defaultValue;
+    return String(it->second.value);
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    size_t len = getBytesLength(key);
+    if (len == 0 || len > maxLen) return 0;
+    memcpy(buf, prefsTable[ns + '\0' + key].value.data(), len);
+    return len;
 }
 
+// Sleeps until the deadline, waking only to handle input. All but the last
+// millisecond is spent blocked in SDL_WaitEventTimeout (which may overshoot by
+// a tick); the tail uses a precise thread sleep so wake-up jitter stays < 1 ms.
 void delay(unsigned long ms) {
-    unsigned long start = millis();
-    while (millis() - start < ms) {
+    using namespace std::chrono;
+    delayCalls++;
+    prefs_poll();
+    if (virtualClock && !recordFile) {
         pump_events();
-        SDL_Delay(1);
+        virtual_advance(ms * 1000ULL);
+        return;
+    }
+    auto deadline = steady_clock::now() + milliseconds(ms);
+
+    pump_events();
+    while (true) {
+        auto now = steady_clock::now();
+        if (now >= deadline) break;
+        long waitMs = (long)duration_cast<milliseconds>(deadline - now).count() - 1;
+        if (waitMs >= 1 && sdl_initialized) {
+            SDL_Event e;
+            if (SDL_WaitEventTimeout(&e, (int)waitMs)) {
+                handle_event(e);
+                pump_events();
+                delayWakeups++;
+            }
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
     }
+
+    long long lateUs = duration_cast<microseconds>(steady_clock::now() - deadline).count();
+    delayLateUsTotal += lateUs;
+    if (lateUs > delayLateUsMax) delayLateUsMax = lateUs;
+
+    // Recording plays in real time but stamps everything with virtual time
+    if (virtualClock) virtual_advance(ms * 1000ULL);
 }
 
 long random(long max) {
@@ -202,13 +1042,236 @@ long random(long min, long max) {
 }
 
 void randomSeed(long seed) {
+    if (replaySeeded) seed = replaySeed;
+    if (recordFile) fprintf(recordFile, "seed %ld\n", seed);
     srand(seed);
 }
 
+// Stands in for the hardware RNG. Runs on the virtual clock (WAV, replay,
+// record) get a fixed sequence so they start alike every time.
+uint32_t esp_random() {
+    static uint64_t counter = 0;
+    if (virtualClock) {
+        uint64_t z = (counter += 0x9E3779B97F4A7C15ULL);  // splitmix64
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return (uint32_t)(z ^ (z >> 31));
+    }
+    static std::random_device device;
+    return device();
+}
+
 int analogRead(uint8_t pin) {
     return 0; 
 }
 
+// ================= Overdraw =================
+
+// Black for untouched, then blue, green, yellow, orange and red as a pixel
+// is painted again; white from 8 writes up
+static uint32_t overdraw_color(uint8_t depth) {
+    static const uint32_t ramp[8] = {
+        0xFF000000, 0xFF1830A0, 0xFF10A040, 0xFFE0D020, 0xFFF08010, 0xFFE02010, 0xFFB00000, 0xFF800000
+    };
+    return depth < 8 ? ramp[depth] : 0xFFFFFFFF;
+}
+
+static void overdraw_start(const char* mode) {
+    overdrawDepth = new uint8_t[screenW * screenH]();
+    overdrawHeatBuffer = strcmp(mode, "heat") == 0 ? new uint32_t[screenW * screenH] : nullptr;
+    printf("Sim: counting overdraw%s\n", overdrawHeatBuffer
+           ? ", showing the heatmap (black 0, blue 1, green 2, yellow 3, orange 4, red 5-7, white 8+ writes)" : "");
+}
+
+// Tallies the frame being presented and clears the counts for the next.
+// Returns the heatmap to show in its place, or null.
+static const uint32_t* overdraw_frame() {
+    if (!overdrawDepth) return nullptr;
+    if (overdrawScene < 0) {
+        overdrawScenes.emplace_back();
+        overdrawScenes.back().name = "-";
+        overdrawScene = 0;
+    }
+    OverdrawScene& scene = overdrawScenes[overdrawScene];
+    int pixels = screenW * screenH;
+    unsigned long covered = 0;
+    for (int i = 0; i < pixels; i++) {
+        uint8_t depth = overdrawDepth[i];
+        if (depth) covered++;
+        if (depth > scene.depthMax) scene.depthMax = depth;
+        if (overdrawHeatBuffer) overdrawHeatBuffer[i] = overdraw_color(depth);
+    }
+    scene.frames++;
+    scene.writes += overdrawWrites;
+    scene.covered += covered;
+    if (overdrawWrites > scene.writesMax) scene.writesMax = overdrawWrites;
+
+    memset(overdrawDepth, 0, pixels);
+    overdrawWrites = 0;
+    return overdrawHeatBuffer;
+}
+
+void simOverdrawScene(const char* name) {
+    if (!overdrawDepth) return;
+    for (size_t i = 0; i < overdrawScenes.size(); i++) {
+        if (overdrawScenes[i].name == name) {
+            overdrawScene = (int)i;
+            return;
+        }
+    }
+    overdrawScenes.emplace_back();
+    overdrawScenes.back().name = name;
+    overdrawScene = (int)overdrawScenes.size() - 1;
+}
+
+// ================= Simulator Diagnostics =================
+
+SimCpuStats simCpuStats() {
+    SimCpuStats stats;
+    stats.wallMs = (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    stats.cpuMs = (unsigned long)((std::clock() - startCpu) * 1000.0 / CLOCKS_PER_SEC);
+    stats.cpuPercent = stats.wallMs > 0 ? 100.0f * stats.cpuMs / stats.wallMs : 0.0f;
+    stats.delayCalls = delayCalls;
+    stats.delayWakeups = delayWakeups;
+    stats.delayLateUsAvg = delayCalls > 0 ? (unsigned long)(delayLateUsTotal / (long long)delayCalls) : 0;
+    stats.delayLateUsMax = (unsigned long)delayLateUsMax;
+    return stats;
+}
+
+SimAudioStats simAudioStats() {
+    SimAudioStats stats = {};
+    stats.buffers = audioStats.buffers.load(std::memory_order_relaxed);
+    stats.samples = audioStats.samples.load(std::memory_order_relaxed);
+    stats.periodUs = (unsigned long)((unsigned long long)audioBufferSamples * 1000000 / audioSampleRate);
+    stats.callbackUsMax = audioStats.callbackUsMax.load(std::memory_order_relaxed);
+    stats.intervalUsMax = audioStats.intervalUsMax.load(std::memory_order_relaxed);
+    stats.underruns = audioStats.underruns.load(std::memory_order_relaxed);
+    stats.lastUnderrunMs = audioStats.lastUnderrunMs.load(std::memory_order_relaxed);
+    if (stats.buffers > 0) {
+        stats.callbackUsAvg = (unsigned long)(audioStats.callbackUsTotal.load(std::memory_order_relaxed) / stats.buffers);
+    }
+    if (stats.buffers > 1) {
+        stats.intervalUsAvg = (unsigned long)(audioStats.intervalUsTotal.load(std::memory_order_relaxed) / (stats.buffers - 1));
+        stats.intervalUsMin = audioStats.intervalUsMin.load(std::memory_order_relaxed);
+    }
+    if (stats.periodUs > 0) {
+        stats.loadPercent = 100.0f * stats.callbackUsAvg / stats.periodUs;
+        stats.loadPercentMax = 100.0f * stats.callbackUsMax / stats.periodUs;
+    }
+    return stats;
+}
+
+SimPrefsStats simPrefsStats() {
+    SimPrefsStats stats = prefsStats;
+    stats.entries = prefsTable.size();
+    stats.commitUsAvg = stats.commits ? (unsigned long)(prefsCommitUsTotal / stats.commits) : 0;
+    return stats;
+}
+
+void simBenchDisplay() {
+    if (!pixelBuffer) pixelBuffer = new uint32_t[screenW * screenH];
+    lcdEcho = false;
+}
+
+void simMixAudio(int voices, int16_t* out, int samples) {
+    static const uint16_t chord[audioVoices] = {262, 330, 392, 523};
+    AudioState state;
+    for (int v = 0; v < voices && v < audioVoices; v++) {
+        AudioCommand cmd = {};
+        cmd.type = CMD_TONE;
+        cmd.channel = v;
+        cmd.phaseStep = (uint32_t)(((uint64_t)chord[v] << 32) / audioSampleRate);
+        cmd.duration = UINT32_MAX;
+        audio_apply(&state, cmd);
+    }
+    for (int done = 0; done < samples; done += audioBufferSamples) {
+        audio_render(&state, out + done, min(audioBufferSamples, samples - done));
+    }
+}
+
+#ifndef BOO_BENCH
+// Upper edge of the bucket holding the given fraction of samples
+static const char* latency_percentile(double fraction) {
+    static char text[latencyBuckets][16];
+    unsigned long target = (unsigned long)(fraction * latencyCount + 0.999);
+    unsigned long seen = 0;
+    int b = 0;
+    for (; b < latencyBuckets - 1; b++) {
+        seen += latencyHist[b];
+        if (seen >= target) break;
+    }
+    if (b == latencyBuckets - 1) snprintf(text[b], sizeof(text[b]), ">%lums", latencyBucketMs[b - 1]);
+    else snprintf(text[b], sizeof(text[b]), "<%lums", latencyBucketMs[b]);
+    return text[b];
+}
+
+static void print_latency_report() {
+    if (latencyCount == 0) return;
+    printf("Sim: key-to-photon n=%lu avg=%.1fms max=%.1fms p50%s p95%s\n", latencyCount,
+           latencyUsTotal / 1000.0 / latencyCount, latencyUsMax / 1000.0,
+           latency_percentile(0.50), latency_percentile(0.95));
+    printf("Sim: key-to-photon histogram");
+    for (int b = 0; b < latencyBuckets; b++) {
+        if (b < latencyBuckets - 1) printf(" <%lu:%lu", latencyBucketMs[b], latencyHist[b]);
+        else printf(" >=%lu:%lu", latencyBucketMs[b - 1], latencyHist[b]);
+    }
+    printf(" (ms:count)\n");
+}
+
+// Per scene: writes per frame, writes per pixel drawn, and the share of
+// writes that a later one painted over
+static void print_overdraw_report() {
+    if (!overdrawDepth) return;
+    int pixels = screenW * screenH;
+    for (const OverdrawScene& scene : overdrawScenes) {
+        if (scene.frames == 0) continue;
+        double writesAvg = (double)scene.writes / scene.frames;
+        double perPixel = scene.covered ? (double)scene.writes / scene.covered : 0.0;
+        double hidden = scene.writes ? 100.0 * (scene.writes - scene.covered) / scene.writes : 0.0;
+        printf("Sim: overdraw %-6s frames=%lu writes/frame avg=%.0f (%.2fx screen) max=%lu, "
+               "%.2f writes per pixel drawn, %.0f%% painted over, deepest pixel %u\n",
+               scene.name.c_str(), scene.frames, writesAvg, writesAvg / pixels, scene.writesMax,
+               perPixel, hidden, scene.depthMax);
+    }
+}
+
+static void print_sim_report() {
+    SimCpuStats cpu = simCpuStats();
+    printf("Sim: CPU %.1f%% of one core (%lums cpu / %lums wall)\n", cpu.cpuPercent, cpu.cpuMs, cpu.wallMs);
+    printf("Sim: delay() calls=%lu input-wakeups=%lu late avg=%luus max=%luus\n",
+           cpu.delayCalls, cpu.delayWakeups, cpu.delayLateUsAvg, cpu.delayLateUsMax);
+    print_latency_report();
+    print_overdraw_report();
+    if (prefsLoaded) {
+        SimPrefsStats prefs = simPrefsStats();
+        printf("Sim: prefs %s entries=%lu puts=%lu unchanged=%lu commits=%lu bytes written=%llu "
+               "commit avg=%luus max=%luus\n", prefsPath.empty() ? "(memory only)" : prefsPath.c_str(),
+               prefs.entries, prefs.puts, prefs.putsUnchanged, prefs.commits, prefs.bytesWritten,
+               prefs.commitUsAvg, prefs.commitUsMax);
+    }
+    if (audioDevice != 0) {
+        SimAudioStats audio = simAudioStats();
+        printf("Sim: audio buffer=%d samples (%.1fms) buffers=%lu samples=%llu underruns=%lu\n", audioBufferSamples,
+               audio.periodUs / 1000.0, audio.buffers, audio.samples, audio.underruns);
+        printf("Sim: audio callback avg=%luus max=%luus (load %.2f%% avg, %.2f%% max), interval avg=%luus min=%luus max=%luus\n",
+               audio.callbackUsAvg, audio.callbackUsMax, audio.loadPercent, audio.loadPercentMax,
+               audio.intervalUsAvg, audio.intervalUsMin, audio.intervalUsMax);
+        printf("Sim: mixer %d voices, steals=%lu dropped=%lu clipped=%lu\n",
+               audioVoices, audioState.steals, audioState.dropped, audioState.clipped);
+        double sendAvg = audioQueue.sent ? (double)audioQueue.sendNsTotal / (audioQueue.sent + audioQueue.full) : 0.0;
+        printf("Sim: command queue sent=%lu full=%lu depth max=%u/%u drained max=%u per buffer, "
+               "speaker call avg=%.0fns max=%luns (no lock)\n",
+               audioQueue.sent, audioQueue.full, audioQueue.maxDepth, audioQueueSize, audioQueue.maxDrained,
+               sendAvg, audioQueue.sendNsMax);
+    } else if (wavPath) {
+        printf("Sim: offline mix %llu samples steals=%lu dropped=%lu clipped=%lu\n",
+               (unsigned long long)audioState.renderedSamples,
+               audioState.steals, audioState.dropped, audioState.clipped);
+    }
+}
+#endif
+
 // ================= Helper: Color Conversion =================
 // Convert RGB565 (uint16_t) to ARGB8888 (uint32_t)
 uint32_t rgb565to8888(uint16_t color) {
@@ -227,7 +1290,52 @@ uint32_t rgb565to8888(uint16_t color) {
 // ================= M5Cardputer Implementation =================
 
 void M5Cardputer_Class::begin(Config config, bool enableSerial) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+    const char* latencyEnv = std::getenv("BOO_LATENCY_LOG");
+    latencyLog = latencyEnv && latencyEnv[0] != '\0' && latencyEnv[0] != '0';
+
+    const char* overdrawEnv = std::getenv("BOO_OVERDRAW");
+    if (overdrawEnv && overdrawEnv[0] != '\0' && overdrawEnv[0] != '0') overdraw_start(overdrawEnv);
+
+    const char* wavEnv = std::getenv("BOO_WAV");
+    const char* replayEnv = std::getenv("BOO_REPLAY");
+    const char* recordEnv = std::getenv("BOO_RECORD");
+    bool capture = wavEnv && wavEnv[0] != '\0';
+    bool replay = replayEnv && replayEnv[0] != '\0';
+    bool record = recordEnv && recordEnv[0] != '\0';
+
+    // Headless runs: no window, no audio device, virtual clock
+    if (capture || replay) {
+        if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+            printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+            return;
+        }
+        if (replay && !replay_load(replayEnv)) exit(1);
+        if (capture && !capture_start(wavEnv)) return;
+        // Both set: re-record, feeding the old inputs and logging fresh hashes
+        if (replay && record && !record_start(recordEnv)) exit(1);
+        virtualClock = true;
+        pixelBuffer = new uint32_t[screenW * screenH];
+        sdl_initialized = true;
+        startTime = std::chrono::steady_clock::now();
+        replayStart = startTime;
+        startCpu = std::clock();
+        if (capture) printf("Sim: capturing audio to %s on a virtual clock\n", wavEnv);
+        if (replay) {
+            printf("Sim: replaying %s (%zu key events, %zu frames)%s\n", replayEnv,
+                   replayKeys.size(), replayFrames.size(), record ? ", re-recording" : "");
+        }
+        return;
+    }
+
+    // Recording keeps the window but has no sound: the audio device runs on
+    // real time and the recording on virtual time
+    if (record) {
+        if (!record_start(recordEnv)) return;
+        virtualClock = true;
+        printf("Sim: recording to %s (audio off)\n", recordEnv);
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO | (record ? 0 : SDL_INIT_AUDIO)) < 0) {
         printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
         return;
     }
@@ -246,13 +1354,28 @@ void M5Cardputer_Class::begin(Config config, bool enableSerial) {
     texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, screenW, screenH);
     pixelBuffer = new uint32_t[screenW * screenH];
 
+    sdl_initialized = true;
+    startTime = std::chrono::steady_clock::now();
+    startCpu = std::clock();
+    if (record) return;
+
     // Init Audio
+    const char* samplesEnv = std::getenv("BOO_AUDIO_SAMPLES");
+    if (samplesEnv) {
+        int samples = atoi(samplesEnv);
+        if (samples >= 256 && samples <= 4096 && (samples & (samples - 1)) == 0) {
+            audioBufferSamples = samples;
+        } else {
+            printf("Sim: ignoring BOO_AUDIO_SAMPLES=%s (want a power of two, 256..4096)\n", samplesEnv);
+        }
+    }
+
     SDL_AudioSpec want, have;
     SDL_memset(&want, 0, sizeof(want));
-    want.freq = 44100;
+    want.freq = audioSampleRate;
     want.format = AUDIO_S16SYS;
     want.channels = 1;
-    want.samples = 2048;
+    want.samples = audioBufferSamples;
     want.callback = audio_callback;
     want.userdata = &audioState;
 
@@ -262,65 +1385,150 @@ void M5Cardputer_Class::begin(Config config, bool enableSerial) {
     } else {
         SDL_PauseAudioDevice(audioDevice, 0); // Start audio
     }
-
-    sdl_initialized = true;
-    startTime = std::chrono::steady_clock::now();
+    audioStartUs = micros();
 }
 
 void M5Cardputer_Class::update() {
     // Process inputs
     pump_events(); // Poll any final events before frame start
-    
-    // Move pending keys to current keys for this frame
-    currentKeys = pendingKeys;
-    pendingKeys.clear();
-    
-    // Update change flag
-    keyChanged = !currentKeys.empty();
-    
-    // Update Keyboard class state
-    Keyboard.setKeys(currentKeys);
+    prefs_poll();
+
+    // Hand this frame the events gathered since the last update
+    if (replayPath && recordFile && updateCount >= replayEndUpdate) exit(0);  // Re-recording done
+    updateCount++;
+    if (replayPath) replay_keys();
+    Keyboard.nextFrame();
+    if (recordFile) {
+        for (const KeyEvent& e : Keyboard.events()) {
+            fprintf(recordFile, "key %lu %c %d\n", updateCount, e.down ? 'd' : 'u', e.key);
+        }
+    }
+
+    // Presses the app now knows about start waiting for a frame to show them
+    for (const KeyEvent& e : Keyboard.events()) {
+        if (e.down && keysAwaiting < KeyList::CAPACITY) keysAwaitingPhoton[keysAwaiting++] = e;
+    }
 }
 
 // ================= Keyboard Implementation =================
 
+void Keyboard_Class::pushEvent(const KeyEvent& e) {
+    pending.push(e);
+}
+
+void Keyboard_Class::nextFrame() {
+    frame = pending;
+    pending.clear();
+
+    state.word.clear();
+    for (const KeyEvent& e : frame) {
+        uint8_t k = (uint8_t)e.key & 0x7F;
+        if (e.down) {
+            if (!held[k]) heldCount++;
+            held[k] = true;
+            state.word.push_back(e.key);
+        } else if (held[k]) {
+            held[k] = false;
+            heldCount--;
+        }
+    }
+}
+
 bool Keyboard_Class::isChange() {
-    return keyChanged;
+    return !frame.empty();
 }
 
 bool Keyboard_Class::isPressed() {
-    return !currentKeys.empty();
+    return heldCount > 0 || !state.word.empty();
 }
 
-Keyboard_Class::KeysState Keyboard_Class::keysState() {
-    KeysState state;
-    state.word = currentKeys;
+const Keyboard_Class::KeysState& Keyboard_Class::keysState() {
     return state;
 }
 
-void Keyboard_Class::setKeys(std::vector<char> keys) {
-    currentKeys = keys;
+const KeyEventRing& Keyboard_Class::events() {
+    return frame;
 }
 
 // ================= Speaker Implementation =================
 
 void Speaker_Class::setVolume(uint8_t volume) {
-    audioState.volume = volume;
+    AudioCommand cmd = {};
+    cmd.type = CMD_VOLUME;
+    cmd.volume = volume;
+    audio_send(cmd);
+}
+
+void Speaker_Class::setChannelVolume(uint8_t channel, uint8_t volume) {
+    if (channel >= audioChannels) return;
+    AudioCommand cmd = {};
+    cmd.type = CMD_CHANNEL_VOLUME;
+    cmd.channel = channel;
+    cmd.volume = volume;
+    audio_send(cmd);
 }
 
-void Speaker_Class::tone(uint16_t frequency, uint32_t duration) { 
-    if (audioDevice == 0) return;
-    SDL_LockAudioDevice(audioDevice);
-    audioState.frequency = frequency;
-    audioState.endTime = millis() + duration;
-    SDL_UnlockAudioDevice(audioDevice);
+// Picks the voice for a new sound on `channel`. Runs on the mixer's thread.
+static Voice* claim_voice(AudioState* state, int channel, bool stopCurrent, uint64_t now) {
+    Voice* pick = nullptr;
+
+    // Replace what the channel is playing
+    if (stopCurrent) {
+        for (int v = 0; v < audioVoices; v++) {
+            Voice& voice = state->voices[v];
+            if (voice.channel != channel) continue;
+            if (!pick) pick = &voice;
+            else voice.channel = -1;
+        }
+    }
+
+    // Otherwise any voice that is not sounding
+    for (int v = 0; v < audioVoices && !pick; v++) {
+        Voice& voice = state->voices[v];
+        if (voice.channel < 0 || voice.endSample <= now) pick = &voice;
+    }
+    if (pick) return pick;
+
+    // Pool is full: steal the oldest voice on the lowest channel <= ours
+    for (int v = 0; v < audioVoices; v++) {
+        Voice& voice = state->voices[v];
+        if (voice.channel > channel) continue;
+        if (!pick || voice.channel < pick->channel ||
+            (voice.channel == pick->channel && voice.serial < pick->serial)) {
+            pick = &voice;
+        }
+    }
+    if (pick) state->steals++;
+    else state->dropped++;
+    return pick;
+}
+
+void Speaker_Class::tone(uint16_t frequency, uint32_t duration, int channel, bool stop_current_sound) {
+    if (audioDevice == 0 && !wavFile) return;
+    AudioCommand cmd = {};
+    cmd.type = CMD_TONE;
+    cmd.channel = (channel < 0 || channel >= audioChannels) ? -1 : channel;
+    cmd.stopCurrent = stop_current_sound;
+    cmd.phaseStep = (uint32_t)(((uint64_t)frequency << 32) / audioSampleRate);
+    cmd.duration = duration;
+    cmd.atSample = audio_sample_now();
+    audio_send(cmd);
 }
 
 void Speaker_Class::stop() {
-    if (audioDevice == 0) return;
-    SDL_LockAudioDevice(audioDevice);
-    audioState.frequency = 0;
-    SDL_UnlockAudioDevice(audioDevice);
+    if (audioDevice == 0 && !wavFile) return;
+    AudioCommand cmd = {};
+    cmd.type = CMD_STOP_ALL;
+    audio_send(cmd);
+}
+
+void Speaker_Class::stop(uint8_t channel) {
+    if (audioDevice == 0 && !wavFile) return;
+    if (channel >= audioChannels) return;
+    AudioCommand cmd = {};
+    cmd.type = CMD_STOP_CHANNEL;
+    cmd.channel = channel;
+    audio_send(cmd);
 }
 
 // ================= Graphics Implementation =================
@@ -328,7 +1536,10 @@ void Speaker_Class::stop() {
 void M5Display::fillScreen(uint16_t color) {
     if (!pixelBuffer) return;
     uint32_t c = rgb565to8888(color);
-    for (int i = 0; i < screenW * screenH; i++) pixelBuffer[i] = c;
+    for (int i = 0; i < screenW * screenH; i++) {
+        pixelBuffer[i] = c;
+        overdraw_note(i);
+    }
 }
 
 void M5Display::setRotation(int r) { }
@@ -356,12 +1567,34 @@ void M5Canvas::deleteSprite() { }
 
 void M5Canvas::pushSprite(int x, int y) {
     // This is where we actually RENDER to the window!
+    const uint32_t* heatmap = overdraw_frame();
     if (sdl_initialized && texture) {
-        SDL_UpdateTexture(texture, NULL, pixelBuffer, screenW * sizeof(uint32_t));
+        SDL_UpdateTexture(texture, NULL, heatmap ? heatmap : pixelBuffer, screenW * sizeof(uint32_t));
         SDL_RenderClear(renderer);
         SDL_RenderCopy(renderer, texture, NULL, NULL);
         SDL_RenderPresent(renderer);
     }
+
+    replay_frame();
+
+    // The first frame presented after update() delivered a key reflects it
+    if (keysAwaiting > 0) {
+        unsigned long now = micros();
+        for (int i = 0; i < keysAwaiting; i++) {
+            unsigned long us = now - keysAwaitingPhoton[i].us;
+            if (latencyLog) {
+                printf("Sim: key '%c' at %lums shown after %.1fms\n", keysAwaitingPhoton[i].key,
+                       keysAwaitingPhoton[i].us / 1000, us / 1000.0);
+            }
+            int b = 0;
+            while (b < latencyBuckets - 1 && us >= latencyBucketMs[b] * 1000) b++;
+            latencyHist[b]++;
+            latencyCount++;
+            latencyUsTotal += us;
+            if (us > latencyUsMax) latencyUsMax = us;
+        }
+        keysAwaiting = 0;
+    }
 }
 
 void M5Canvas::fillSprite(uint16_t color) {
@@ -372,6 +1605,7 @@ void M5Canvas::drawPixel(int x, int y, uint16_t color) {
     if (!pixelBuffer) return;
     if (x < 0 || x >= screenW || y < 0 || y >= screenH) return;
     pixelBuffer[y * screenW + x] = rgb565to8888(color);
+    overdraw_note(y * screenW + x);
 }
 
 void M5Canvas::fillCircle(int x0, int y0, int r, uint16_t color) {
@@ -486,6 +1720,7 @@ void drawCharInternal(int x, int y, char c, uint16_t color, int size) {
                         int py = y + row * size + sy;
                         if (px >= 0 && px < screenW && py >= 0 && py < screenH) {
                             pixelBuffer[py * screenW + px] = rgb565to8888(color);
+                            overdraw_note(py * screenW + px);
                         }
                     }
                 }
@@ -496,7 +1731,7 @@ void drawCharInternal(int x, int y, char c, uint16_t color, int size) {
 
 void M5Canvas::print(const char* s) {
     // Debug print to console
-    ::printf("LCD: %s\n", s); 
+    if (lcdEcho) ::printf("LCD: %s\n", s);
     
     while (*s) {
         drawCharInternal(cursorX, cursorY, *s, txtColor, txtSize);
@@ -0,0 +1,323 @@
+#ifdef BOO_BENCH
+
+// Host benchmarks: draw primitives, composite draws, whole scene frames, the
+// game logic and the audio mixer, each timed on its own.
+// Build and run: pio run -e bench && ./.pio/build/bench/program
+//
+//   program [--filter text] [--seconds s] [--json out.json]
+//           [--compare baseline.json] [--threshold percent]
+//
+// --json writes the results for a later --compare. --compare exits with 1
+// when any kernel is slower than in the baseline by more than the threshold
+// (15% by default).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include <M5Cardputer.h>
+#include "BenchKernels.h"
+#include "BooGame.h"
+#include "FixedTrig.h"
+#include "GhostCrowd.h"
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Result {
+    std::string name;
+    double ns;      // Per call, fastest sample
+    double ticks;   // Time-stamp counter ticks per call, ~cycles at the base clock; 0 if unavailable
+    double items;   // Work per call (ghosts, samples); 1 for a draw
+};
+
+class Bench {
+public:
+    Bench(const char* filter, double seconds) : filter(filter), seconds(seconds) {}
+
+    bool wants(const std::string& name) const {
+        return !filter || name.find(filter) != std::string::npos;
+    }
+
+    // Times fn() and records ns per call. Calls run in batches, doubled until
+    // one batch takes 1ms so clock reads stay out of the cost; then five
+    // samples of seconds/5 each are taken and the fastest kept, since other
+    // load on the host only ever adds time.
+    template <typename Fn>
+    void run(const std::string& name, double items, Fn fn) {
+        if (!wants(name)) return;
+
+        long batch = 1;
+        for (;;) {
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < batch; i++) fn();
+            if (secondsSince(start) >= 1e-3) break;
+            batch *= 2;
+        }
+
+        const int samples = 5;
+        double ns[samples];
+        double ticks[samples];
+        for (int s = 0; s < samples; s++) {
+            long calls = 0;
+            double elapsed = 0;
+            auto start = std::chrono::steady_clock::now();
+#ifdef HAVE_TSC
+            uint64_t t0 = __rdtsc();
+#endif
+            do {
+                for (long i = 0; i < batch; i++) fn();
+                calls += batch;
+                elapsed = secondsSince(start);
+            } while (elapsed < seconds / samples);
+#ifdef HAVE_TSC
+            ticks[s] = (double)(__rdtsc() - t0) / calls;
+#else
+            ticks[s] = 0;
+#endif
+            ns[s] = elapsed * 1e9 / calls;
+        }
+        int best = std::min_element(ns, ns + samples) - ns;
+        Result result = {name, ns[best], ticks[best], items};
+        results.push_back(result);
+        printf("%-34s %12.1f %12.1f", name.c_str(), result.ns, result.ticks);
+        if (items > 1) printf(" %12.3e/s", items * 1e9 / result.ns);
+        printf("\n");
+    }
+
+    const std::vector<Result>& all() const { return results; }
+
+private:
+    const char* filter;
+    double seconds;
+    std::vector<Result> results;
+};
+
+// ============== Kernels ==============
+
+static void benchRender(Bench& bench) {
+    simBenchDisplay();
+    BenchKernel kernels[64];
+    int n = benchRenderKernels(kernels, 64);
+    if (n > 64) n = 64;
+    for (int i = 0; i < n; i++) {
+        const BenchKernel& k = kernels[i];
+        std::string name = std::string(k.group) + "/" + k.name;
+        if (!bench.wants(name)) continue;
+        if (k.setup) k.setup(k.arg);
+        bench.run(name, 1, [&] { k.run(k.arg); });
+    }
+}
+
+// Deterministic spread of starting states
+static void spawnCrowd(GhostCrowd& crowd, int n) {
+    crowd.clear();
+    for (int i = 0; i < n; i++) {
+        float x = (float)((i * 37) % (SCREEN_WIDTH - GHOST_SIZE));
+        float y = (float)((i * 53) % (SCREEN_HEIGHT - GHOST_SIZE - 18));
+        float vx = 0.5f + (i % 7) * 0.25f;
+        float vy = 0.4f + (i % 5) * 0.2f;
+        crowd.spawn(x, y, i % 2 ? vx : -vx, i % 3 ? vy : -vy, (uint16_t)(i * 97));
+    }
+}
+
+static void benchGame(Bench& bench) {
+    BooGame single;
+    single.init();
+    bench.run("game/BooGame.update", 1, [&] { single.update(BooGame::STEP_MS); });
+
+    // The crowd against the same work done the old way, one BooGame per ghost
+    const int sizes[] = {64, 1024, 4096, 16384};
+    for (int n : sizes) {
+        char name[64];
+        GhostCrowd crowd(n);
+        spawnCrowd(crowd, n);
+        snprintf(name, sizeof(name), "game/GhostCrowd.step n=%d", n);
+        bench.run(name, n, [&] { crowd.step(); });
+
+        std::vector<BooGame> games(n);
+        for (int i = 0; i < n; i++) {
+            games[i].init();
+            games[i].setVelocity(0.5f + (i % 7) * 0.25f, 0.4f + (i % 5) * 0.2f);
+        }
+        snprintf(name, sizeof(name), "game/BooGame.update x%d", n);
+        bench.run(name, n, [&] {
+            for (int i = 0; i < n; i++) games[i].update();
+        });
+
+        // Keep the results observable so the loops are not optimised away
+        volatile float sink = crowd.x(n / 2) + games[n / 2].getGhostX();
+        (void)sink;
+    }
+}
+
+// One device buffer of the simulator's mixer; samples/s over 44100 is how
+// many times faster than real time it runs
+static void benchAudio(Bench& bench) {
+    const int samples = 2048;
+    static int16_t out[samples];
+    bench.run("audio/mix 1 voice", samples, [] { simMixAudio(1, out, samples); });
+    bench.run("audio/mix 4 voices", samples, [] { simMixAudio(4, out, samples); });
+}
+
+// Largest error of isin/icos against double sin/cos over every angle, as a
+// fraction of 1.0
+static double trigMaxError() {
+    double worst = 0;
+    for (long a = 0; a < TRIG_TURN; a++) {
+        double rad = a * (2 * M_PI / TRIG_TURN);
+        double es = std::fabs(isin((uint16_t)a) / (double)TRIG_ONE - std::sin(rad));
+        double ec = std::fabs(icos((uint16_t)a) / (double)TRIG_ONE - std::cos(rad));
+        if (es > worst) worst = es;
+        if (ec > worst) worst = ec;
+    }
+    return worst;
+}
+
+// One call over a sweep of angles; the results are summed so the calls
+// cannot be dropped
+static void benchTrig(Bench& bench) {
+    const double toRad = 2 * M_PI / TRIG_TURN;
+    const uint16_t step = 40503;  // Odd, so every angle comes up
+    double sum = 0;
+    uint16_t a = 0;
+    bench.run("math/sin", 1, [&] { sum += std::sin(a * toRad); a += step; });
+    bench.run("math/sinf", 1, [&] { sum += sinf(a * (float)toRad); a += step; });
+    bench.run("math/isin", 1, [&] { sum += isin(a); a += step; });
+    volatile double sink = sum;
+    (void)sink;
+
+    if (bench.wants("math/isin")) {
+        double err = trigMaxError();
+        printf("isin/icos max error %.2e (%.2f Q15 steps)\n", err, err * TRIG_ONE);
+    }
+}
+
+// ============== JSON ==============
+
+static bool writeJson(const char* path, const std::vector<Result>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"format\": \"boo-bench 1\",\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ns\": %.2f, \"ticks\": %.1f, \"items\": %.0f}%s\n",
+                r.name.c_str(), r.ns, r.ticks, r.items, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// Reads back what writeJson() wrote: name -> ns. Only the keys this tool
+// writes are understood.
+static bool readJson(const char* path, std::map<std::string, double>* out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "bench: cannot read %s\n", path);
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, got);
+    fclose(f);
+
+    const char* nameKey = "\"name\": \"";
+    const char* nsKey = "\"ns\": ";
+    size_t at = 0;
+    while ((at = text.find(nameKey, at)) != std::string::npos) {
+        size_t begin = at + strlen(nameKey);
+        size_t end = text.find('"', begin);
+        size_t ns = text.find(nsKey, end);
+        if (end == std::string::npos || ns == std::string::npos) break;
+        (*out)[text.substr(begin, end - begin)] = strtod(text.c_str() + ns + strlen(nsKey), nullptr);
+        at = ns;
+    }
+    if (out->empty()) {
+        fprintf(stderr, "bench: no results in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Prints each kernel against the baseline; returns how many regressed
+static int compare(const std::map<std::string, double>& baseline, const std::vector<Result>& results,
+                   double threshold) {
+    printf("\n%-34s %12s %12s %8s\n", "vs baseline", "base ns", "ns", "change");
+    int slower = 0, faster = 0, unmatched = 0;
+    for (const Result& r : results) {
+        auto base = baseline.find(r.name);
+        if (base == baseline.end() || base->second <= 0) {
+            unmatched++;
+            continue;
+        }
+        double change = r.ns / base->second - 1;
+        const char* flag = "";
+        if (change > threshold) {
+            flag = "  SLOWER";
+            slower++;
+        } else if (change < -threshold) {
+            flag = "  faster";
+            faster++;
+        }
+        printf("%-34s %12.1f %12.1f %+7.1f%%%s\n", r.name.c_str(), base->second, r.ns, change * 100, flag);
+    }
+    printf("compare: %zu kernels, %d slower and %d faster by more than %.0f%%, %d not in baseline\n",
+           results.size(), slower, faster, threshold * 100, unmatched);
+    return slower;
+}
+
+int main(int argc, char* argv[]) {
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double seconds = 0.25;
+    double threshold = 0.15;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--filter") && hasValue) filter = argv[++i];
+        else if (!strcmp(argv[i], "--seconds") && hasValue) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && hasValue) jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--compare") && hasValue) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && hasValue) threshold = atof(argv[++i]) / 100;
+        else {
+            fprintf(stderr, "usage: %s [--filter text] [--seconds s] [--json out.json] "
+                            "[--compare baseline.json] [--threshold percent]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Read the baseline first, so a bad path fails before the long run
+    std::map<std::string, double> baseline;
+    if (baselinePath && !readJson(baselinePath, &baseline)) return 2;
+
+    Bench bench(filter, seconds);
+    printf("%-34s %12s %12s %14s\n", "kernel", "ns", "ticks", "items/s");
+    benchRender(bench);
+    benchGame(bench);
+    benchAudio(bench);
+    benchTrig(bench);
+
+    if (jsonPath && !writeJson(jsonPath, bench.all())) return 2;
+    if (baselinePath && compare(baseline, bench.all(), threshold) > 0) return 1;
+    return 0;
+}
+
+#endif
@@ -5,8 +5,11 @@
 
 #include <M5Cardputer.h>
 #include <Preferences.h>
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <ctime>
 
 #if ESP32
 #include "soc/rtc_cntl_reg.h"
@@ -14,9 +17,25 @@
 #endif
 
 #include "BooGame.h" // Include our verified game logic
+#include "Timeline.h"
+#include "FrameGovernor.h"
+#include "EffectBudget.h"
+#include "Song.h"
+#include "GhostCrowd.h"
+#include "Particles.h"
+#include "PetStats.h"
+#include "Snapshot.h"
+#include "FrameProfiler.h"
+#include "PerfMeter.h"
+#include "CountingCanvas.h"
+
+#ifdef BOO_BENCH
+#include "BenchKernels.h"
+#endif
 
-// Double buffer sprite to prevent flickering
-M5Canvas canvas(&M5Cardputer.Display);
+// Double buffer sprite to prevent flickering. It counts what is drawn
+// into it for the performance HUD.
+CountingCanvas canvas(&M5Cardputer.Display);
 
 // ============== Constants ==============
 // SCREEN_WIDTH, SCREEN_HEIGHT, GHOST_SIZE are now in BooGame.h
@@ -30,6 +49,7 @@ M5Canvas canvas(&M5Cardputer.Display);
 #define COLOR_HEART 0xF88F        // Pink/red
 #define COLOR_STAR 0xFFE0         // Yellow
 #define COLOR_SPARKLE 0xCFFF      // Light cyan
+#define COLOR_BAR 0x5010          // Empty part of a stat bar
 #define COLOR_FOOD_RED 0xF800     // Red
 #define COLOR_FOOD_GREEN 0x07E0   // Green
 #define COLOR_FOOD_ORANGE 0xFD20  // Orange
@@ -44,10 +64,22 @@ M5Canvas canvas(&M5Cardputer.Display);
 // ============== Game State ==============
 Preferences prefs;
 BooGame game; // Use the library class
-
-// Sparkle positions (persistent between frames)
-struct Sparkle { int x, y; uint16_t color; int life; };
-Sparkle sparkles[8];
+PetStats pet;
+
+// Particles: one pool per kind, each drawn in a single batch. Scenes borrow
+// the pools and runScene() empties them again afterwards.
+ParticlePool sparkles(8);
+ParticlePool stars(12);
+ParticlePool hearts(4);
+
+// Idle sparkles wink in over the top of the screen for 10..29 steps
+const ParticleEmitter idleSparkle = {0, 0, 239, 99, 0, 0, 0, 0, 10, 29, 1, 1, COLOR_SPARKLE, COLOR_STAR};
+// Celebration stars and dance sparkles stay put until the next cheer or note
+// re-scatters them
+const ParticleEmitter cheerStar = {0, 0, 239, 119, 0, 0, 0, 0, 1000, 1000, 3, 6, COLOR_STAR, COLOR_STAR};
+const ParticleEmitter danceSparkle = {0, 0, 239, 109, 0, 0, 0, 0, 1000, 1000, 1, 1, COLOR_SPARKLE, COLOR_STAR};
+// Hearts rise 4px per 100ms from beside the ghost, drifting a little sideways
+const ParticleEmitter risingHeart = {150, 90, 20, 0, -0.3f, 0.3f, -1.32f, -1.32f, 91, 91, 1, 1, COLOR_HEART, COLOR_HEART};
 
 // ============== Music Notes ==============
 #define NOTE_G3  196
@@ -66,26 +98,99 @@ Sparkle sparkles[8];
 #define NOTE_F5  698
 #define NOTE_G5  784
 
-// Happy Birthday melody (with rests as 0)
-const int happyBirthday[] = {
+// Speaker channels. Music and effects play on separate voices; when voices
+// run short the simulator's mixer lets the higher channel win.
+#define CH_MUSIC 0
+#define CH_SFX 1
+
+// ============== Songs ==============
+
+// MIDI pitches for the packed songs
+#define PITCH_C4  60
+#define PITCH_D4  62
+#define PITCH_E4  64
+#define PITCH_F4  65
+#define PITCH_G4  67
+#define PITCH_A4  69
+#define PITCH_Bb4 70
+#define PITCH_B4  71
+#define PITCH_C5  72
+#define PITCH_E5  76
+#define PITCH_G5  79
+
+#define N SONG_NOTE
+#define R SONG_REST
+
+// Happy Birthday, in 50ms ticks
+const SongNote happyBirthdayNotes[] = {
     // "Hap-py birth-day to you"
-    NOTE_C4, NOTE_C4, NOTE_D4, NOTE_C4, NOTE_F4, NOTE_E4, 0,
+    N(PITCH_C4, 3), N(PITCH_C4, 3), N(PITCH_D4, 6), N(PITCH_C4, 6), N(PITCH_F4, 6), N(PITCH_E4, 12), R(8),
     // "Hap-py birth-day to you"
-    NOTE_C4, NOTE_C4, NOTE_D4, NOTE_C4, NOTE_G4, NOTE_F4, 0,
+    N(PITCH_C4, 3), N(PITCH_C4, 3), N(PITCH_D4, 6), N(PITCH_C4, 6), N(PITCH_G4, 6), N(PITCH_F4, 12), R(8),
     // "Hap-py birth-day dear Boo-oo"
-    NOTE_C4, NOTE_C4, NOTE_C5, NOTE_A4, NOTE_F4, NOTE_E4, NOTE_D4, 0,
+    N(PITCH_C4, 3), N(PITCH_C4, 3), N(PITCH_C5, 6), N(PITCH_A4, 6), N(PITCH_F4, 6), N(PITCH_E4, 6), N(PITCH_D4, 12), R(8),
     // "Hap-py birth-day to you"
-    NOTE_Bb4, NOTE_Bb4, NOTE_A4, NOTE_F4, NOTE_G4, NOTE_F4, 0, 0
+    N(PITCH_Bb4, 3), N(PITCH_Bb4, 3), N(PITCH_A4, 6), N(PITCH_F4, 6), N(PITCH_G4, 6), N(PITCH_F4, 16), R(12), R(16)
+};
+
+// Happy feeding melody, in 20ms ticks
+const SongNote feedNotes[] = {
+    N(PITCH_C5, 6), N(PITCH_E5, 6), N(PITCH_G5, 11), N(PITCH_E5, 6), N(PITCH_C5, 11)
 };
-const int happyBirthdayDurations[] = {
-    150, 150, 300, 300, 300, 600, 400,
-    150, 150, 300, 300, 300, 600, 400,
-    150, 150, 300, 300, 300, 300, 600, 400,
-    150, 150, 300, 300, 300, 800, 600, 800
+
+// Yankee Doodle, one tick per beat
+const SongNote yankeeDoodleNotes[] = {
+    // "Yankee Doodle went to town"
+    N(PITCH_C4, 1), N(PITCH_C4, 1), N(PITCH_D4, 1), N(PITCH_E4, 1), N(PITCH_C4, 1), N(PITCH_E4, 1), N(PITCH_D4, 2), R(1),
+    // "Riding on a pony"
+    N(PITCH_C4, 1), N(PITCH_C4, 1), N(PITCH_D4, 1), N(PITCH_E4, 1), N(PITCH_C4, 2), R(1), N(PITCH_B4, 2), R(1),
+    // "Stuck a feather in his cap"
+    N(PITCH_C4, 1), N(PITCH_C4, 1), N(PITCH_D4, 1), N(PITCH_E4, 1), N(PITCH_F4, 1), N(PITCH_E4, 1), N(PITCH_D4, 1), N(PITCH_C4, 1),
+    // "And called it macaroni"
+    N(PITCH_B4, 1), N(PITCH_G4, 1), N(PITCH_A4, 1), N(PITCH_B4, 1), N(PITCH_C5, 2), N(PITCH_C5, 2), R(1), R(2)
+};
+
+// Dance finale, in 10ms ticks
+const SongNote fanfareNotes[] = {
+    N(PITCH_C5, 17), N(PITCH_E5, 17), N(PITCH_G5, 32)
 };
-const int happyBirthdayLen = 30;
-int musicIndex = 0;
-unsigned long lastNoteTime = 0;
+
+// "Johnny I Hardly Knew Ye" (When Johnny Comes Marching Home) in C, one tick per beat
+const SongNote marchNotes[] = {
+    // "When Johnny comes marching home again"
+    N(PITCH_G4, 1), N(PITCH_G4, 1), N(PITCH_G4, 1), N(PITCH_A4, 1), N(PITCH_G4, 1), N(PITCH_F4, 1), N(PITCH_E4, 1), N(PITCH_D4, 2),
+    // "Hurrah, hurrah"
+    N(PITCH_C4, 1), N(PITCH_E4, 1), N(PITCH_G4, 1), N(PITCH_G4, 1), N(PITCH_A4, 1), N(PITCH_G4, 1), N(PITCH_F4, 1), N(PITCH_E4, 2),
+    // "We'll give him a hearty welcome then"
+    N(PITCH_D4, 1), N(PITCH_D4, 1), N(PITCH_E4, 1), N(PITCH_F4, 1), N(PITCH_G4, 1), N(PITCH_E4, 1), N(PITCH_C4, 1), N(PITCH_D4, 2),
+    // "Hurrah, hurrah"
+    N(PITCH_E4, 1), N(PITCH_F4, 1), N(PITCH_G4, 1), N(PITCH_A4, 1), N(PITCH_G4, 1), N(PITCH_F4, 1), N(PITCH_E4, 1), N(PITCH_D4, 2)
+};
+
+// Intro arpeggio, one note every 120ms
+const SongNote introNotes[] = {
+    N(PITCH_C4, 1), N(PITCH_E4, 1), N(PITCH_G4, 1), N(PITCH_C5, 1), N(PITCH_E5, 1), N(PITCH_G5, 1)
+};
+
+#undef N
+#undef R
+
+#define SONG(notes, loopStart, tickMs, gapMs) \
+    {notes, sizeof(notes) / sizeof(notes[0]), loopStart, tickMs, gapMs}
+
+const Song happyBirthdaySong = SONG(happyBirthdayNotes, 0, 50, 30);
+const Song feedSong = SONG(feedNotes, -1, 20, 20);
+const Song danceSong = SONG(yankeeDoodleNotes, 0, 120, 20);
+const Song fanfareSong = SONG(fanfareNotes, -1, 10, 20);
+const Song marchSong = SONG(marchNotes, 0, 160, 20);
+const Song introSong = SONG(introNotes, -1, 120, 20);
+
+const unsigned long songBytes = sizeof(happyBirthdayNotes) + sizeof(feedNotes) + sizeof(yankeeDoodleNotes) +
+                                sizeof(fanfareNotes) + sizeof(marchNotes) + sizeof(introNotes) + 6 * sizeof(Song);
+
+// The idle tune keeps its place while scenes play theirs
+SongPlayer idleMusic;
+SongPlayer sceneMusic;
 
 // Volume control
 int volume = 255;
@@ -93,9 +198,137 @@ bool muted = false;
 bool smokeMode = false;
 bool smokeDone = false;
 const unsigned long smokeSceneMs = 5000;
+const unsigned long frameMs = 33;  // ~30 FPS
+
+// Idle screen pacing
+FrameGovernor governor;
+unsigned long lastPhysicsTime = 0;       // Last time the game was handed elapsed time
+const unsigned long idlePollMs = 20;     // Input/music granularity while waiting
+
+// How many ghosts the crowd scene spawns. The simulator takes BOO_CROWD=n
+// to stress-test rendering with far more.
+int crowdSize() {
+    int size = 32;
+#if !ESP32
+    const char* crowdEnv = std::getenv("BOO_CROWD");
+    if (crowdEnv && atoi(crowdEnv) > 0) size = min(atoi(crowdEnv), 65535);  // The budget counts in 16 bits
+#endif
+    return size;
+}
+
+// Scene effects shed detail when frames run over the frame period
+EffectBudget effects;
+const int fxDanceSparkles = effects.declare("dance sparkles", 0, 5);
+const int fxCheerStars = effects.declare("cheer stars", 1, 12);
+const int fxHopStars = effects.declare("hop stars", 2, 5);
+const int fxMarchers = effects.declare("marchers", 3, 8);
+const int fxCrowd = effects.declare("crowd", 1, crowdSize());
+
+// Where frame time goes, per scene; reported at exit in the simulator
+FrameProfiler profiler(micros);
+const int profIdle = profiler.declare("idle");
+const int profIntro = profiler.declare("intro");
+const int profFeed = profiler.declare("feed");
+const int profDance = profiler.declare("dance");
+const int profMarch = profiler.declare("march");
+const int profGame = profiler.declare("game");
+const int profCrowd = profiler.declare("crowd");
+const int profStats = profiler.declare("stats");
+
+// Performance HUD, toggled with P
+bool hudShown = false;
+PerfMeter meter;
+CountingCanvas::Counts frameCounts;  // Drawn in the frame last presented
 
 // ============== Helper Functions ==============
 
+// Seconds on the clock pet stats are kept against. The ESP32 RTC keeps time()
+// counting through deep sleep; after a power cut it starts again from zero
+// and the pet resumes as it was saved. The simulator's clock follows its
+// virtual time in reproducible runs.
+uint32_t petClock() {
+#if ESP32
+    return (uint32_t)time(nullptr);
+#else
+    return simEpochSeconds();
+#endif
+}
+
+void savePet() {
+    prefs.putBytes("pet", &pet.saved(), sizeof(PetState));
+}
+
+// Pets saved before PetState carried fractions of a point are 12 bytes;
+// they load with the fractions at zero
+void loadPet() {
+    PetState saved = {};
+    size_t got = prefs.getBytes("pet", &saved, sizeof(saved));
+    if (got == sizeof(saved) || got == offsetof(PetState, hungerPart)) {
+        pet.restore(saved, petClock());
+    } else {
+        pet.hatch(petClock());
+        savePet();
+    }
+}
+
+// Where the ghost was and how the UI was set, saved under "snap" after every
+// scene and setting change. A valid one lets boot skip the intro. Bump
+// snapshotVersion whenever this layout changes.
+const uint8_t snapshotVersion = 1;
+struct UiSnapshot {
+    BooGame::State game;
+    uint8_t muted;
+    uint8_t volume;
+};
+
+void saveSnapshot() {
+    UiSnapshot snap;
+    memset(&snap, 0, sizeof(snap));  // Padding too, so equal states save equal bytes
+    snap.game = game.saveState();
+    snap.muted = muted;
+    snap.volume = volume;
+
+    uint8_t buf[sizeof(UiSnapshot) + SNAPSHOT_OVERHEAD];
+    size_t len = snapshotWrite(snapshotVersion, &snap, sizeof(snap), buf, sizeof(buf));
+    prefs.putBytes("snap", buf, len);
+}
+
+bool loadSnapshot() {
+    uint8_t buf[sizeof(UiSnapshot) + SNAPSHOT_OVERHEAD];
+    UiSnapshot snap;
+    size_t len = prefs.getBytes("snap", buf, sizeof(buf));
+    if (!snapshotRead(snapshotVersion, buf, len, &snap, sizeof(snap))) return false;
+
+    game.loadState(snap.game);
+    muted = snap.muted != 0;
+    volume = snap.volume;
+    M5Cardputer.Speaker.setVolume(volume);
+    return true;
+}
+
+// ============== Boot Timing ==============
+// setup() marks the end of each phase; the report shows where startup went,
+// counted from reset (from process start in the simulator)
+
+struct BootPhase { const char* name; unsigned long endUs; };
+const int maxBootPhases = 6;
+BootPhase bootPhases[maxBootPhases];
+int bootPhaseCount = 0;
+
+void bootPhaseDone(const char* name) {
+    if (bootPhaseCount < maxBootPhases) bootPhases[bootPhaseCount++] = {name, micros()};
+}
+
+void printBootReport(bool resumed) {
+    Serial.printf("Boot: %s", resumed ? "resumed" : "cold");
+    unsigned long startUs = 0;
+    for (int i = 0; i < bootPhaseCount; i++) {
+        Serial.printf(" %s=%.1fms", bootPhases[i].name, (bootPhases[i].endUs - startUs) / 1000.0);
+        startUs = bootPhases[i].endUs;
+    }
+    Serial.printf(" total=%.1fms\n", startUs / 1000.0);
+}
+
 void enterDownloadMode() {
     M5Cardputer.Display.fillScreen(0x0000);
     M5Cardputer.Display.setTextColor(0xFFFF);
@@ -115,14 +348,106 @@ void enterDownloadMode() {
 }
 
 void playNote(int freq, int duration) {
-    M5Cardputer.Speaker.tone(freq, duration);
+    M5Cardputer.Speaker.tone(freq, duration, CH_SFX);
     delay(duration + 20);
 }
 
+// Sounds whatever the player has due on the music channel. Muting only
+// silences it; the song keeps its place.
+void playDueNotes(SongPlayer& player, unsigned long now) {
+    SongEvent note;
+    while (player.next(now, &note)) {
+        if (note.freq > 0 && !muted) M5Cardputer.Speaker.tone(note.freq, note.ms, CH_MUSIC);
+    }
+}
+
 inline bool smokeTimedOut(unsigned long startMs) {
     return smokeMode && (millis() - startMs >= smokeSceneMs);
 }
 
+// Two lines in the top left corner, drawn over the finished frame. Its
+// time and draws are left out of the numbers it shows.
+void drawHud() {
+    ProfileScope scope(profiler, FrameProfiler::HUD);
+    char audio[12];
+#if ESP32
+    strcpy(audio, "--");  // M5Unified does not expose the speaker task's load
+#else
+    snprintf(audio, sizeof(audio), "%.2f%%", simAudioStats().loadPercent);
+#endif
+    canvas.fillRect(0, 0, 156, 19, 0x0000);
+    canvas.setTextColor(COLOR_STAR);
+    canvas.setTextSize(1);
+    canvas.setCursor(2, 1);
+    canvas.printf("%4.1f FPS %5.2fMS MAX %5.2f", meter.fps(), meter.workUsAvg() / 1000.0f,
+                  meter.workUsMax() / 1000.0f);
+    canvas.setCursor(2, 10);
+    canvas.printf("DC %lu PX %.1fK AU %s", (unsigned long)meter.drawCalls(), meter.pixels() / 1000.0f, audio);
+}
+
+// Clears and presents a frame, timed for the profiler. What is drawn in
+// between is counted for the HUD.
+void clearFrame() {
+    ProfileScope scope(profiler, FrameProfiler::CLEAR);
+    canvas.take();
+    canvas.fillSprite(COLOR_BG);
+}
+
+void presentFrame() {
+    frameCounts = canvas.take();
+    if (hudShown) {
+        drawHud();
+        canvas.take();
+    }
+    ProfileScope scope(profiler, FrameProfiler::PRESENT);
+    canvas.pushSprite(0, 0);
+}
+
+// Switches the scene frames are profiled under, and in the simulator the
+// one overdraw is counted under. Each scene starts silent: a song the last
+// one left playing would otherwise go on through finishFrame().
+void enterScene(int scene) {
+    sceneMusic.stop();
+    profiler.setScene(scene);
+#if !ESP32
+    simOverdrawScene(profiler.name(scene));
+#endif
+}
+
+// Closes the frame for the profiler and the HUD
+void frameDone() {
+    profiler.endFrame();
+    meter.frame(micros(), profiler.lastUs(FrameProfiler::WORK), frameCounts.drawCalls, frameCounts.pixels);
+}
+
+// Ends a scene frame: reports its cost to the effect budget and sleeps off
+// whatever is left of the frame period, waking for any scene music note that
+// falls due in between.
+void finishFrame(unsigned long frameStartUs) {
+    unsigned long workUs = micros() - frameStartUs;
+    effects.endFrame(workUs, frameMs * 1000);
+    unsigned long workMs = workUs / 1000;
+    unsigned long wakeAt = millis() + (workMs < frameMs ? frameMs - workMs : 1);
+    while (true) {
+        unsigned long now = millis();
+        playDueNotes(sceneMusic, now);
+        if ((long)(wakeAt - now) <= 0) break;
+        unsigned long wait = wakeAt - now;
+        if (sceneMusic.playing() && !sceneMusic.done(now)) {
+            wait = min(wait, max(sceneMusic.nextAt() - now, 1UL));
+        }
+        ProfileScope scope(profiler, FrameProfiler::SLEEP);
+        delay(wait);
+    }
+    frameDone();
+}
+
+// Reads the keyboard, timed for the profiler
+void pumpInput() {
+    ProfileScope scope(profiler, FrameProfiler::INPUT);
+    M5Cardputer.update();
+}
+
 void smokeHold(unsigned long startMs) {
     while (!smokeTimedOut(startMs)) {
         M5Cardputer.update();
@@ -132,26 +457,55 @@ void smokeHold(unsigned long startMs) {
 
 // ============== Drawing Functions (use canvas) ==============
 
-void drawSparkle(int x, int y, uint16_t color) {
-    canvas.drawPixel(x, y, color);
-    canvas.drawPixel(x-1, y, color);
-    canvas.drawPixel(x+1, y, color);
-    canvas.drawPixel(x, y-1, color);
-    canvas.drawPixel(x, y+1, color);
-}
-
 void drawHeart(int x, int y, uint16_t color) {
+    ProfileScope scope(profiler, FrameProfiler::EFFECTS);
     canvas.fillCircle(x - 3, y, 4, color);
     canvas.fillCircle(x + 3, y, 4, color);
     canvas.fillTriangle(x - 7, y + 2, x + 7, y + 2, x, y + 10, color);
 }
 
 void drawStar(int x, int y, int size, uint16_t color) {
+    ProfileScope scope(profiler, FrameProfiler::EFFECTS);
     canvas.fillTriangle(x, y - size, x - size/2, y + size/2, x + size/2, y + size/2, color);
     canvas.fillTriangle(x, y + size, x - size/2, y - size/2, x + size/2, y - size/2, color);
 }
 
+// Batched particle draws: one call per pool, at most `limit` particles
+
+void drawSparkles(const ParticlePool& pool, int limit) {
+    ProfileScope scope(profiler, FrameProfiler::EFFECTS);
+    int n = pool.size() < limit ? pool.size() : limit;
+    for (int i = 0; i < n; i++) {
+        int x = (int)pool.x(i), y = (int)pool.y(i);
+        canvas.fillRect(x - 1, y, 3, 1, pool.color(i));
+        canvas.fillRect(x, y - 1, 1, 3, pool.color(i));
+    }
+}
+
+void drawStars(const ParticlePool& pool, int limit) {
+    ProfileScope scope(profiler, FrameProfiler::EFFECTS);
+    int n = pool.size() < limit ? pool.size() : limit;
+    for (int i = 0; i < n; i++) {
+        drawStar((int)pool.x(i), (int)pool.y(i), pool.particleSize(i), pool.color(i));
+    }
+}
+
+void drawHearts(const ParticlePool& pool, int limit) {
+    ProfileScope scope(profiler, FrameProfiler::EFFECTS);
+    int n = pool.size() < limit ? pool.size() : limit;
+    for (int i = 0; i < n; i++) {
+        drawHeart((int)pool.x(i), (int)pool.y(i), pool.color(i));
+    }
+}
+
+void clearParticles() {
+    sparkles.clear();
+    stars.clear();
+    hearts.clear();
+}
+
 void drawGhost(int x, int y, bool blinking, bool dancing = false, int danceFrame = 0) {
+    ProfileScope scope(profiler, FrameProfiler::GHOST);
     int wobble = dancing ? (danceFrame % 2 == 0 ? -3 : 3) : 0;
     int squish = dancing ? (danceFrame % 4 < 2 ? 2 : -2) : 0;
 
@@ -197,6 +551,7 @@ void drawGhost(int x, int y, bool blinking, bool dancing = false, int danceFrame
 }
 
 void drawGhostEating(int x, int y, int frame) {
+    ProfileScope scope(profiler, FrameProfiler::GHOST);
     drawGhost(x, y, frame % 3 == 0);
     // Open/close mouth
     if (frame % 2 == 0) {
@@ -408,144 +763,199 @@ void drawFoodEgg(int x, int y, int scale) {
     p.circle(12, 12, 3, COLOR_FOOD_YELLOW);
 }
 
+// ============== Animation Tracks ==============
+// Scene motion is a function of elapsed ms, so a late or dropped frame only
+// costs smoothness, never position. Periods match the old per-frame steps.
+
+// Food icon hops one step every 300ms
+const Track foodBounce({{0, 0, Ease::Step}, {300, 1, Ease::Step}, {600, 0, Ease::Step}}, Playback::Loop);
+
+// Eating: a heart leaves every 625ms, and after a 500ms pause a ring of stars
+// flies out 8px per 100ms, flattened to suit the wide screen
+const unsigned long heartSpacingMs = 625;
+const int feedHearts = 4;
+const unsigned long burstStartMs = 500;
+const float burstSpeed = 2.64f;  // px per step
+const float burstDir[6][2] = {
+    {1.0f, 0.0f}, {0.5f, 0.433f}, {-0.5f, 0.433f}, {-1.0f, 0.0f}, {-0.5f, -0.433f}, {0.5f, -0.433f}
+};
+
+// Dance: notes drift on slow sines, stars hop on a 1.2s triangle wave
+const Track noteSwayX({{0, -20, Ease::InOutSine}, {1885, 20, Ease::InOutSine}}, Playback::PingPong);
+const Track noteSwayY({{0, -15, Ease::InOutSine}, {2513, 15, Ease::InOutSine}}, Playback::PingPong);
+const Track danceStarHop({{0, 10, Ease::Linear}, {600, 0, Ease::Linear}}, Playback::PingPong);
+
+// March: 0..12px bob on a 400ms triangle wave, neighbours 100ms apart
+const Track marchBob({{0, 12, Ease::Linear}, {200, 0, Ease::Linear}}, Playback::PingPong);
+const float marchSpeed = 1.5f / 33.0f;  // px per ms
+
+// Intro: ghost drops in and bounces back up over 15 beats of 110ms
+const unsigned long introBeatMs = 110;
+const Track introBounce({{0, 25, Ease::Linear}, {770, 60, Ease::Linear}, {1540, 25, Ease::Linear}});
+
 // ============== Scenes ==============
 
-void feedScene() {
-    // Happy feeding melody
-    const int melody[] = {NOTE_C5, NOTE_E5, NOTE_G5, NOTE_E5, NOTE_C5};
-    const int durations[] = {100, 100, 200, 100, 200};
-
-    struct FoodItem { const char* name; void (*draw)(int, int, int); };
-    const FoodItem foodItems[] = {
-        {"APPLE", drawFoodApple},
-        {"BANANA", drawFoodBanana},
-        {"CHERRY", drawFoodCherry},
-        {"GRAPE", drawFoodGrape},
-        {"MANGO", drawFoodMango},
-        {"PIZZA", drawFoodPizza},
-        {"BURGER", drawFoodBurger},
-        {"TACO", drawFoodTaco},
-        {"SUSHI", drawFoodSushi},
-        {"RAMEN", drawFoodRamen},
-        {"COOKIE", drawFoodCookie},
-        {"CAKE", drawFoodCake},
-        {"DONUT", drawFoodDonut},
-        {"CANDY", drawFoodCandy},
-        {"CHOCOLATE", drawFoodChoco},
-        {"FRIES", drawFoodFries},
-        {"STEAK", drawFoodSteak},
-        {"SALAD", drawFoodSalad},
-        {"BREAD", drawFoodBread},
-        {"EGG", drawFoodEgg},
-    };
-    const int foodCount = sizeof(foodItems) / sizeof(foodItems[0]);
-    const FoodItem selectedFood = foodItems[random(foodCount)];
+struct FoodItem { const char* name; void (*draw)(int, int, int); };
+const FoodItem foodItems[] = {
+    {"APPLE", drawFoodApple},
+    {"BANANA", drawFoodBanana},
+    {"CHERRY", drawFoodCherry},
+    {"GRAPE", drawFoodGrape},
+    {"MANGO", drawFoodMango},
+    {"PIZZA", drawFoodPizza},
+    {"BURGER", drawFoodBurger},
+    {"TACO", drawFoodTaco},
+    {"SUSHI", drawFoodSushi},
+    {"RAMEN", drawFoodRamen},
+    {"COOKIE", drawFoodCookie},
+    {"CAKE", drawFoodCake},
+    {"DONUT", drawFoodDonut},
+    {"CANDY", drawFoodCandy},
+    {"CHOCOLATE", drawFoodChoco},
+    {"FRIES", drawFoodFries},
+    {"STEAK", drawFoodSteak},
+    {"SALAD", drawFoodSalad},
+    {"BREAD", drawFoodBread},
+    {"EGG", drawFoodEgg},
+};
+const int foodCount = sizeof(foodItems) / sizeof(foodItems[0]);
 
-    unsigned long sceneStart = millis();
-    const int foodFrames = 15;
-    const int eatFrames = 20;
+// Feed runs as three phases: show the food, eat it, celebrate
+const Sequence feedPhases({1500, 2300, 1000});
+
+void drawFeedFood(const FoodItem& food, unsigned long t) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
     const int foodScale = 2;
     const int foodBaseSize = 22;
     const int foodSize = foodBaseSize * foodScale;
     const int nameSize = 2;
     const int nameHeight = 8 * nameSize;
     const int groupSpacing = 6;
+
+    const int nameWidth = strlen(food.name) * 6 * nameSize;
+    const int groupHeight = foodSize + groupSpacing + nameHeight;
+    const int foodX = (SCREEN_WIDTH - foodSize) / 2;
+    const int baseFoodY = (SCREEN_HEIGHT - groupHeight) / 2;
+    const int textX = (SCREEN_WIDTH - nameWidth) / 2;
+    const int textY = baseFoodY + foodSize + groupSpacing;
+    int bounce = (int)foodBounce.at(t);
+    {
+        ProfileScope foodScope(profiler, FrameProfiler::FOOD);
+        food.draw(foodX, baseFoodY + bounce * foodScale, foodScale);
+    }
+
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_HIGHLIGHT);
+    canvas.setTextSize(nameSize);
+    canvas.setCursor(textX, textY);
+    canvas.print(food.name);
+}
+
+void drawFeedEating(unsigned long t) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
     const char* thanksText = "SO YUMMY!";
     const int thanksSize = 2;
     const int thanksHeight = 8 * thanksSize;
 
-    for (int frame = 0; frame < foodFrames; frame++) {
-        if (smokeTimedOut(sceneStart)) return;
-        canvas.fillSprite(COLOR_BG);
-
-        const int nameWidth = strlen(selectedFood.name) * 6 * nameSize;
-        const int groupHeight = foodSize + groupSpacing + nameHeight;
-        const int foodX = (SCREEN_WIDTH - foodSize) / 2;
-        const int baseFoodY = (SCREEN_HEIGHT - groupHeight) / 2;
-        const int textX = (SCREEN_WIDTH - nameWidth) / 2;
-        const int textY = baseFoodY + foodSize + groupSpacing;
-        int bounce = (frame % 6 < 3) ? 0 : 1;
-        selectedFood.draw(foodX, baseFoodY + bounce * foodScale, foodScale);
+    // Ghost eating animation (same for all foods), chomping every 100ms
+    drawGhostEating(104, 50, t / 100);
 
-        canvas.setTextColor(COLOR_HIGHLIGHT);
-        canvas.setTextSize(nameSize);
-        canvas.setCursor(textX, textY);
-        canvas.print(selectedFood.name);
+    // Floating hearts and the star burst, moved by feedScene()
+    drawHearts(hearts, feedHearts);
+    drawStars(stars, 6);
 
-        canvas.pushSprite(0, 0);
-        delay(100);
+    if (t >= 300) {
+        ProfileScope textScope(profiler, FrameProfiler::TEXT);
+        const int thanksWidth = strlen(thanksText) * 6 * thanksSize;
+        const int thanksX = (SCREEN_WIDTH - thanksWidth) / 2;
+        const int thanksY = SCREEN_HEIGHT - thanksHeight - 12;
+        canvas.setTextColor(COLOR_STAR);
+        canvas.setTextSize(thanksSize);
+        canvas.setCursor(thanksX, thanksY);
+        canvas.print(thanksText);
     }
+}
 
-    for (int frame = 0; frame < eatFrames; frame++) {
-        if (smokeTimedOut(sceneStart)) return;
-        canvas.fillSprite(COLOR_BG);
+void drawFeedCelebration(unsigned long t) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    drawGhost(104, 50, (t / 100) % 2 == 0);
 
-        // Ghost eating animation (same for all foods)
-        drawGhostEating(104, 50, frame);
+    // Explosion of stars, re-scattered by feedScene() on every cheer
+    drawStars(stars, effects.count(fxCheerStars));
 
-        // Floating hearts
-        for (int h = 0; h < 4; h++) {
-            int heartY = 90 - (frame * 4) - (h * 25);
-            int heartX = 160 + sin(frame * 0.5 + h) * 15;
-            if (heartY > 5 && heartY < 130) {
-                drawHeart(heartX, heartY, COLOR_HEART);
-            }
-        }
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_STAR);
+    canvas.setTextSize(2);
+    const char* yummyText = "SO YUMMY!";
+    int yummyWidth = strlen(yummyText) * 6 * 2;
+    int yummyX = (SCREEN_WIDTH - yummyWidth) / 2;
+    canvas.setCursor(yummyX, 10);
+    canvas.print(yummyText);
+}
+
+void feedScene() {
+    enterScene(profFeed);
+    const FoodItem& selectedFood = foodItems[game.rng().below(foodCount)];
+    pet.feed(petClock());
+    savePet();
+
+    unsigned long sceneStart = millis();
+    unsigned long lastStep = sceneStart;
+    int lastCheer = -1;
+    int heartsSent = 0;
+    bool burstSent = false;
 
-        // Stars bursting out
-        if (frame > 5) {
-            for (int s = 0; s < 6; s++) {
-                int angle = s * 60 + frame * 10;
-                int dist = (frame - 5) * 8;
-                int sx = 120 + cos(angle * 0.0174) * dist;
-                int sy = 65 + sin(angle * 0.0174) * dist * 0.5;
-                if (sx > 0 && sx < 240 && sy > 0 && sy < 135) {
-                    drawStar(sx, sy, 4, COLOR_STAR);
+    while (true) {
+        if (smokeTimedOut(sceneStart)) return;
+        unsigned long frameStart = micros();
+        unsigned long local;
+        int phase = feedPhases.locate(millis() - sceneStart, &local);
+        if (phase < 0) break;
+
+        unsigned long now = millis();
+        {
+            ProfileScope scope(profiler, FrameProfiler::UPDATE);
+            hearts.update(now - lastStep);
+            stars.update(now - lastStep);
+        }
+        lastStep = now;
+        if (phase == 1) {
+            while (heartsSent < feedHearts && local >= heartsSent * heartSpacingMs) {
+                hearts.emit(risingHeart, 1, game.rng());
+                heartsSent++;
+            }
+            if (!burstSent && local >= burstStartMs) {
+                burstSent = true;
+                for (int s = 0; s < 6; s++) {
+                    stars.spawn(120, 65, burstDir[s][0] * burstSpeed, burstDir[s][1] * burstSpeed,
+                                1000, 4, COLOR_STAR);
                 }
             }
+        } else if (phase == 2 && (int)(local / 100) != lastCheer) {
+            stars.clear();
+            stars.emit(cheerStar, 12, game.rng());
         }
 
-        if (frame > 2) {
-            const int thanksWidth = strlen(thanksText) * 6 * thanksSize;
-            const int thanksX = (SCREEN_WIDTH - thanksWidth) / 2;
-            const int thanksY = SCREEN_HEIGHT - thanksHeight - 12;
-            canvas.setTextColor(COLOR_STAR);
-            canvas.setTextSize(thanksSize);
-            canvas.setCursor(thanksX, thanksY);
-            canvas.print(thanksText);
-        }
-
-        canvas.pushSprite(0, 0);
-
-        // Play melody
-        if (frame < 5) {
-            playNote(melody[frame], durations[frame]);
+        clearFrame();
+        if (phase == 0) {
+            drawFeedFood(selectedFood, local);
+        } else if (phase == 1) {
+            drawFeedEating(local);
         } else {
-            delay(100);
+            drawFeedCelebration(local);
         }
-    }
-
-    // Celebration
-    for (int i = 0; i < 10; i++) {
-        if (smokeTimedOut(sceneStart)) return;
-        canvas.fillSprite(COLOR_BG);
-        drawGhost(104, 50, i % 2 == 0);
-
-        // Explosion of stars
-        for (int s = 0; s < 12; s++) {
-            drawStar(random(240), random(120), random(3, 7), COLOR_STAR);
+        presentFrame();
+
+        // Play melody while eating, then a rising cheer every 100ms
+        if (phase == 1) {
+            if (!sceneMusic.playing()) sceneMusic.start(&feedSong, millis());
+            playDueNotes(sceneMusic, millis());
+        } else if (phase == 2 && (int)(local / 100) != lastCheer) {
+            lastCheer = local / 100;
+            M5Cardputer.Speaker.tone(NOTE_C5 + lastCheer * 50, 80, CH_SFX);
         }
 
-        canvas.setTextColor(COLOR_STAR);
-        canvas.setTextSize(2);
-        const char* yummyText = "SO YUMMY!";
-        int yummyWidth = strlen(yummyText) * 6 * 2;
-        int yummyX = (SCREEN_WIDTH - yummyWidth) / 2;
-        canvas.setCursor(yummyX, 10);
-        canvas.print(yummyText);
-
-        canvas.pushSprite(0, 0);
-        playNote(NOTE_C5 + i * 50, 80);
+        finishFrame(frameStart);
     }
 
     if (smokeMode) {
@@ -553,65 +963,63 @@ void feedScene() {
     }
 }
 
-void danceScene() {
-    // Yankee Doodle melody
-    const int melody[] = {
-        // "Yankee Doodle went to town"
-        NOTE_C4, NOTE_C4, NOTE_D4, NOTE_E4, NOTE_C4, NOTE_E4, NOTE_D4, 0,
-        // "Riding on a pony"
-        NOTE_C4, NOTE_C4, NOTE_D4, NOTE_E4, NOTE_C4, 0, NOTE_B4, 0,
-        // "Stuck a feather in his cap"
-        NOTE_C4, NOTE_C4, NOTE_D4, NOTE_E4, NOTE_F4, NOTE_E4, NOTE_D4, NOTE_C4,
-        // "And called it macaroni"
-        NOTE_B4, NOTE_G4, NOTE_A4, NOTE_B4, NOTE_C5, NOTE_C5, 0, 0
-    };
-    const int beats[] = {
-        1, 1, 1, 1, 1, 1, 2, 1,
-        1, 1, 1, 1, 2, 1, 2, 1,
-        1, 1, 1, 1, 1, 1, 1, 1,
-        1, 1, 1, 1, 2, 2, 1, 2
-    };
-    int tempo = 120;
+void drawDanceFrame(unsigned long t, int danceFrame) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    // Dancing ghost in center, stepping on every note
+    drawGhost(104, 55, danceFrame % 8 < 2, true, danceFrame);
+
+    // Musical notes floating
+    for (int n = 0; n < 4; n++) {
+        ProfileScope textScope(profiler, FrameProfiler::TEXT);
+        int noteX = 40 + n * 50 + noteSwayX.at(t + 942 + n * 600);
+        int noteY = 20 + noteSwayY.at(t + 2513 + n * 800);
+        canvas.setTextColor(n % 2 == 0 ? COLOR_STAR : COLOR_HEART);
+        canvas.setTextSize(2);
+        canvas.setCursor(noteX, noteY);
+        canvas.print((char)14); // Musical note character
+    }
 
-    unsigned long sceneStart = millis();
-    for (int frame = 0; frame < 60; frame++) {
-        if (smokeTimedOut(sceneStart)) return;
-        canvas.fillSprite(COLOR_BG);
+    // Sparkles
+    drawSparkles(sparkles, effects.count(fxDanceSparkles));
 
-        // Dancing ghost in center
-        drawGhost(104, 55, frame % 8 < 2, true, frame);
+    // Bouncing stars at bottom, thinned out from the middle under load
+    int hopCount = effects.count(fxHopStars);
+    for (int s = 0; s < 5; s++) {
+        if (hopCount < 5 && s * hopCount % 5 >= hopCount) continue;
+        int bounce = danceStarHop.at(t + s * 360);
+        drawStar(30 + s * 45, 115 - bounce, 5, COLOR_STAR);
+    }
+}
 
-        // Musical notes floating
-        for (int n = 0; n < 4; n++) {
-            int noteX = 40 + n * 50 + sin(frame * 0.2 + n) * 20;
-            int noteY = 20 + cos(frame * 0.15 + n) * 15;
-            canvas.setTextColor(n % 2 == 0 ? COLOR_STAR : COLOR_HEART);
-            canvas.setTextSize(2);
-            canvas.setCursor(noteX, noteY);
-            canvas.print((char)14); // Musical note character
-        }
+void danceScene() {
+    enterScene(profDance);
+    const int danceNotes = 60;
 
-        // Sparkles
-        for (int s = 0; s < 5; s++) {
-            int sx = random(240);
-            int sy = random(110);
-            drawSparkle(sx, sy, frame % 2 == 0 ? COLOR_SPARKLE : COLOR_STAR);
-        }
+    unsigned long sceneStart = millis();
+    sceneMusic.start(&danceSong, sceneStart, danceNotes);
+    unsigned long sparkleNote = 0;
 
-        // Bouncing stars at bottom
-        for (int s = 0; s < 5; s++) {
-            int bounce = abs((frame + s * 3) % 10 - 5) * 2;
-            drawStar(30 + s * 45, 115 - bounce, 5, COLOR_STAR);
+    while (true) {
+        if (smokeTimedOut(sceneStart)) return;
+        unsigned long frameStart = micros();
+        unsigned long t = millis() - sceneStart;
+
+        // The dance ends once its last note has played out
+        if (sceneMusic.done(millis())) break;
+        playDueNotes(sceneMusic, millis());
+
+        // Sparkles are re-scattered on every note, rests included
+        if (sceneMusic.notesPlayed() != sparkleNote) {
+            sparkleNote = sceneMusic.notesPlayed();
+            sparkles.clear();
+            sparkles.emit(danceSparkle, 5, game.rng());
         }
 
-        canvas.pushSprite(0, 0);
+        clearFrame();
+        drawDanceFrame(t, sceneMusic.notesPlayed() - 1);
+        presentFrame();
 
-        // Play melody note
-        int noteIdx = frame % 32;
-        if (melody[noteIdx] > 0 && !muted) {
-            M5Cardputer.Speaker.tone(melody[noteIdx], beats[noteIdx] * tempo - 20);
-        }
-        delay(beats[noteIdx] * tempo);
+        finishFrame(frameStart);
     }
 
     // Final pose
@@ -627,9 +1035,12 @@ void danceScene() {
     canvas.print("YAY!");
     canvas.pushSprite(0, 0);
 
-    playNote(NOTE_C5, 150);
-    playNote(NOTE_E5, 150);
-    playNote(NOTE_G5, 300);
+    // Hold the pose through the fanfare
+    sceneMusic.start(&fanfareSong, millis());
+    for (unsigned long now = millis(); !sceneMusic.done(now); now = millis()) {
+        playDueNotes(sceneMusic, now);
+        delay(max(sceneMusic.nextAt() - now, 1UL));
+    }
     delay(500);
 
     if (smokeMode) {
@@ -637,92 +1048,79 @@ void danceScene() {
     }
 }
 
-void marchScene() {
-    // "Johnny I Hardly Knew Ye" (When Johnny Comes Marching Home) in C
-    const int melody[] = {
-        // "When Johnny comes marching home again"
-        NOTE_G4, NOTE_G4, NOTE_G4, NOTE_A4, NOTE_G4, NOTE_F4, NOTE_E4, NOTE_D4,
-        // "Hurrah, hurrah"
-        NOTE_C4, NOTE_E4, NOTE_G4, NOTE_G4, NOTE_A4, NOTE_G4, NOTE_F4, NOTE_E4,
-        // "We'll give him a hearty welcome then"
-        NOTE_D4, NOTE_D4, NOTE_E4, NOTE_F4, NOTE_G4, NOTE_E4, NOTE_C4, NOTE_D4,
-        // "Hurrah, hurrah"
-        NOTE_E4, NOTE_F4, NOTE_G4, NOTE_A4, NOTE_G4, NOTE_F4, NOTE_E4, NOTE_D4
-    };
-    const int beats[] = {
-        1, 1, 1, 1, 1, 1, 1, 2,
-        1, 1, 1, 1, 1, 1, 1, 2,
-        1, 1, 1, 1, 1, 1, 1, 2,
-        1, 1, 1, 1, 1, 1, 1, 2
-    };
-    const int melodyLen = sizeof(melody) / sizeof(melody[0]);
-    int tempo = 160;
+void drawMarchFrame(unsigned long t) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    // Infinite stream of marching ghosts
+    // Ghosts are positioned at: leadX - (i * 45)
+    // We only draw those visible on screen (-40 to 280)
+
+    // i * 45 < leadX + 40  -> i < (leadX + 40) / 45
+    // i * 45 > leadX - 280 -> i > (leadX - 280) / 45
+
+    float leadX = t * marchSpeed;
+    int maxI = floor((leadX + 40) / 45.0);
+    int minI = floor((leadX - 280) / 45.0);
+    bool blink = (t % 200) < 100;
+
+    int marchers = effects.count(fxMarchers);
+
+    for (int i = minI; i <= maxI && i - minI < marchers; i++) {
+        float gx = leadX - (i * 45);
+        // Bobbing motion linked to identity 'i'
+        int bob = marchBob.at((long)t + i * 100);
+        drawGhost((int)gx, 60 - bob, blink);
+    }
+
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_TEXT);
+    canvas.setTextSize(2);
+    canvas.setCursor(60, 20);
+    canvas.print("MARCHING!");
+}
 
-    float leadX = 0;
-    
+void marchScene() {
+    enterScene(profMarch);
     // Animation loop (run indefinitely until key press)
     unsigned long startScene = millis();
-    int noteIdx = 0;
-    unsigned long nextNoteTime = 0;
+    sceneMusic.start(&marchSong, startScene);
 
     while (true) {
-        unsigned long now = millis();
         if (smokeTimedOut(startScene)) break;
+        unsigned long frameStart = micros();
+        unsigned long t = millis() - startScene;
 
-        // Music (Looping)
-        if (!muted && now >= nextNoteTime) {
-            if (noteIdx >= melodyLen) noteIdx = 0; // Loop melody
-            
-            int duration = beats[noteIdx] * tempo;
-            if (melody[noteIdx] > 0) {
-                M5Cardputer.Speaker.tone(melody[noteIdx], duration - 20);
-            }
-            nextNoteTime = now + duration;
-            noteIdx++;
-        }
+        // Music (looping)
+        playDueNotes(sceneMusic, millis());
 
         // Render
-        canvas.fillSprite(COLOR_BG);
-
-        int frame = (now - startScene) / 50; // Animation frame counter
-        
-        // Infinite stream of marching ghosts
-        // Ghosts are positioned at: leadX - (i * 45)
-        // We only draw those visible on screen (-40 to 280)
-        
-        // i * 45 < leadX + 40  -> i < (leadX + 40) / 45
-        // i * 45 > leadX - 280 -> i > (leadX - 280) / 45
-        
-        int maxI = floor((leadX + 40) / 45.0);
-        int minI = floor((leadX - 280) / 45.0);
-
-        for (int i = minI; i <= maxI; i++) {
-            float gx = leadX - (i * 45);
-            // Bobbing motion linked to identity 'i'
-            int marchBob = abs((frame + i * 2) % 8 - 4) * 3;
-            drawGhost((int)gx, 60 - marchBob, frame % 4 < 2, false, frame + i);
-        }
-
-        canvas.setTextColor(COLOR_TEXT);
-        canvas.setTextSize(2);
-        canvas.setCursor(60, 20);
-        canvas.print("MARCHING!");
-
-        canvas.pushSprite(0, 0);
-
-        // Update Position
-        leadX += 1.5; // Walking speed
+        clearFrame();
+        drawMarchFrame(t);
+        presentFrame();
 
         // Handle Exit
-        M5Cardputer.update();
+        pumpInput();
         if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) break;
 
-        delay(33);
+        finishFrame(frameStart);
     }
+    sceneMusic.stop();
     if (!smokeMode) delay(200);
 }
 
+void drawCatchFrame(int gx, int starX, int score, int rounds) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    drawGhost(gx, 75, false);
+    drawStar(starX, 30, 10, COLOR_STAR);
+
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_HIGHLIGHT);
+    canvas.setTextSize(1);
+    canvas.setCursor(5, 5);
+    canvas.printf("Stars: %d/%d", score, rounds);
+}
+
 void gameScene() {
+    enterScene(profGame);
     unsigned long sceneStart = millis();
     int score = 0;
     int rounds = 5;
@@ -759,24 +1157,19 @@ void gameScene() {
     for (int round = 0; round < rounds; round++) {
         if (smokeTimedOut(sceneStart)) return;
         int starX = -20;
-        int speed = 4 + random(3);
+        int speed = 4 + game.rng().below(3);
         bool caught = false;
         bool done = false;
 
+        // Frames are counted from here; the instructions and results are not
+        profiler.startFrame();
         while (!done && starX < 260) {
             if (smokeTimedOut(sceneStart)) return;
-            canvas.fillSprite(COLOR_BG);
-            drawGhost(gx, 75, false);
-            drawStar(starX, 30, 10, COLOR_STAR);
+            clearFrame();
+            drawCatchFrame(gx, starX, score, rounds);
+            presentFrame();
 
-            canvas.setTextColor(COLOR_HIGHLIGHT);
-            canvas.setTextSize(1);
-            canvas.setCursor(5, 5);
-            canvas.printf("Stars: %d/%d", score, rounds);
-
-            canvas.pushSprite(0, 0);
-
-            M5Cardputer.update();
+            pumpInput();
             if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
                 if (abs(starX - (gx + 16)) < 35) {
                     caught = true;
@@ -786,7 +1179,11 @@ void gameScene() {
             }
 
             starX += speed;
-            delay(25);
+            {
+                ProfileScope scope(profiler, FrameProfiler::SLEEP);
+                delay(25);
+            }
+            frameDone();
         }
 
         // Result
@@ -799,7 +1196,7 @@ void gameScene() {
             canvas.setCursor(85, 20);
             canvas.print("YAY!");
             for (int s = 0; s < 10; s++) {
-                drawStar(random(240), random(60), 5, COLOR_STAR);
+                drawStar(game.rng().below(240), game.rng().below(60), 5, COLOR_STAR);
             }
             canvas.pushSprite(0, 0);
             playNote(NOTE_E5, 100);
@@ -815,6 +1212,9 @@ void gameScene() {
         delay(600);
     }
 
+    pet.play(petClock());
+    savePet();
+
     // Final score
     for (int i = 0; i < 15; i++) {
         if (smokeTimedOut(sceneStart)) return;
@@ -846,6 +1246,112 @@ void gameScene() {
     }
 }
 
+const unsigned long crowdSceneMs = 8000;
+
+// Fills the crowd with ghosts at random spots, speeds and blink phases
+void scatterCrowd(GhostCrowd& crowd) {
+    Pcg32& rng = game.rng();
+    crowd.clear();
+    for (int i = 0; i < crowd.capacity(); i++) {
+        float vx = rng.between(4, 16) / 10.0f;
+        float vy = rng.between(3, 12) / 10.0f;
+        crowd.spawn(rng.below(SCREEN_WIDTH - GHOST_SIZE), rng.below(SCREEN_HEIGHT - GHOST_SIZE - 18),
+                    rng.below(2) ? vx : -vx, rng.below(2) ? vy : -vy, rng.below(GhostCrowd::BLINK_PERIOD_MS));
+    }
+}
+
+// Draws the first `shown` ghosts of the crowd
+void drawCrowdFrame(const GhostCrowd& crowd, int shown) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    for (int i = 0; i < shown; i++) {
+        drawGhost((int)crowd.x(i), (int)crowd.y(i), crowd.isBlinking(i));
+    }
+
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_TEXT);
+    canvas.setTextSize(1);
+    canvas.setCursor(5, SCREEN_HEIGHT - 12);
+    canvas.printf("CROWD: %d/%d", shown, crowd.size());
+}
+
+void crowdScene() {
+    enterScene(profCrowd);
+    // Allocated on first use, so the RAM is only spent if the scene runs
+    static GhostCrowd crowd(crowdSize());
+    scatterCrowd(crowd);
+
+    unsigned long sceneStart = millis();
+    unsigned long lastStep = sceneStart;
+    while (millis() - sceneStart < crowdSceneMs) {
+        unsigned long frameStart = micros();
+        unsigned long now = millis();
+        {
+            ProfileScope scope(profiler, FrameProfiler::UPDATE);
+            crowd.update(now - lastStep);
+        }
+        lastStep = now;
+
+        // Under load the budget thins the crowd out from the back
+        clearFrame();
+        int shown = min((int)effects.count(fxCrowd), crowd.size());
+        drawCrowdFrame(crowd, shown);
+        presentFrame();
+
+        pumpInput();
+        if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) break;
+
+        finishFrame(frameStart);
+    }
+}
+
+const unsigned long statsSceneMs = 5000;
+
+void drawStatBar(int y, const char* label, uint16_t value, uint16_t color) {
+    {
+        ProfileScope textScope(profiler, FrameProfiler::TEXT);
+        canvas.setTextColor(COLOR_TEXT);
+        canvas.setTextSize(1);
+        canvas.setCursor(80, y);
+        canvas.print(label);
+    }
+    canvas.fillRect(80, y + 10, 150, 8, COLOR_BAR);
+    canvas.fillRect(80, y + 10, 150 * value / PetStats::MAX, 8, color);
+}
+
+// Stats are read straight from the clock each frame; nothing needs ticking
+void drawStatsFrame(uint32_t now) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    uint32_t age = pet.ageSeconds(now);
+    drawGhost(20, 40, pet.isHungry(now));
+
+    {
+        ProfileScope textScope(profiler, FrameProfiler::TEXT);
+        canvas.setTextColor(COLOR_HIGHLIGHT);
+        canvas.setTextSize(1);
+        canvas.setCursor(80, 10);
+        canvas.printf("AGE: %lud %luh %lum", (unsigned long)(age / 86400),
+                      (unsigned long)(age / 3600 % 24), (unsigned long)(age / 60 % 60));
+    }
+    drawStatBar(35, pet.isHungry(now) ? "HUNGER (feed me!)" : "HUNGER", pet.hunger(now), COLOR_FOOD_ORANGE);
+    drawStatBar(70, "HAPPINESS", pet.happiness(now), COLOR_HEART);
+}
+
+void statsScene() {
+    enterScene(profStats);
+    unsigned long sceneStart = millis();
+    while (millis() - sceneStart < statsSceneMs) {
+        unsigned long frameStart = micros();
+        clearFrame();
+        drawStatsFrame(petClock());
+        presentFrame();
+
+        pumpInput();
+        if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) break;
+
+        finishFrame(frameStart);
+    }
+}
+
 void runSmokeSequence() {
     feedScene();
     danceScene();
@@ -853,81 +1359,279 @@ void runSmokeSequence() {
     gameScene();
 }
 
+#if !ESP32
+// One line per subsystem so CI logs show regressions at a glance
+void printSmokeSummary() {
+    SimCpuStats cpu = simCpuStats();
+    SimAudioStats audio = simAudioStats();
+    Serial.printf("Smoke: cpu %.1f%% over %lums\n", cpu.cpuPercent, cpu.wallMs);
+    Serial.printf("Smoke: audio buffers=%lu load avg=%.2f%% max=%.2f%% interval max=%luus underruns=%lu\n",
+                  audio.buffers, audio.loadPercent, audio.loadPercentMax, audio.intervalUsMax, audio.underruns);
+}
+
+// Frame profile per scene: a table on stdout, and the same numbers as JSON
+// in BOO_PROFILE (default boo_profile.json) for tools to compare runs
+void printProfileReport() {
+    const int seriesCount = FrameProfiler::SERIES_COUNT;
+    Serial.printf("Profile: %-6s %-8s %7s %8s %8s %8s\n", "scene", "phase", "frames", "p50us", "p99us", "maxus");
+    for (int s = 0; s < profiler.size(); s++) {
+        if (profiler.frames(s) == 0) continue;
+        // Work and the whole frame first, then each phase that took any time
+        for (int k = 0; k < seriesCount; k++) {
+            int series = (FrameProfiler::WORK + k) % seriesCount;
+            if (series < FrameProfiler::WORK && profiler.maxUs(s, series) == 0) continue;
+            Serial.printf("Profile: %-6s %-8s %7lu %8lu %8lu %8lu\n", profiler.name(s),
+                          FrameProfiler::seriesName(series), profiler.frames(s), profiler.percentile(s, series, 0.50f),
+                          profiler.percentile(s, series, 0.99f), profiler.maxUs(s, series));
+        }
+    }
+
+    const char* path = std::getenv("BOO_PROFILE");
+    if (!path || path[0] == '\0') path = "boo_profile.json";
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        Serial.printf("Profile: cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "{\n  \"format\": \"boo-profile 1\",\n  \"scenes\": [");
+    const char* sep = "\n";
+    for (int s = 0; s < profiler.size(); s++) {
+        if (profiler.frames(s) == 0) continue;
+        fprintf(f, "%s    {\"name\": \"%s\", \"frames\": %lu, \"us\": {", sep, profiler.name(s), profiler.frames(s));
+        for (int series = 0; series < seriesCount; series++) {
+            fprintf(f, "%s\n      \"%s\": {\"p50\": %lu, \"p99\": %lu, \"max\": %lu}", series ? "," : "",
+                    FrameProfiler::seriesName(series), profiler.percentile(s, series, 0.50f),
+                    profiler.percentile(s, series, 0.99f), profiler.maxUs(s, series));
+        }
+        fprintf(f, "\n    }}");
+        sep = ",\n";
+    }
+    fprintf(f, "\n  ]\n}\n");
+    fclose(f);
+    Serial.printf("Profile: wrote %s\n", path);
+}
+#endif
+
+// ============== Idle Screen ==============
+
+void drawIdleFrame() {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    drawSparkles(sparkles, sparkles.capacity());
+
+    // Draw ghost using state from library
+    drawGhost((int)game.getRenderX(), (int)game.getRenderY(), game.isBlinking());
+
+    // Draw UI hints
+    ProfileScope textScope(profiler, FrameProfiler::TEXT);
+    canvas.setTextColor(COLOR_TEXT);
+    canvas.setTextSize(1);
+    canvas.setCursor(5, SCREEN_HEIGHT - 22);
+    canvas.print("F:Feed D:Dance G:Game A:March C:Crowd");
+    canvas.setCursor(5, SCREEN_HEIGHT - 12);
+    canvas.printf("S:Stats P:HUD M:%s", muted ? "OFF" : "ON");
+}
+
+void tickMusic(unsigned long now) {
+    // Play Happy Birthday (non-blocking)
+    if (!idleMusic.playing()) idleMusic.start(&happyBirthdaySong, now);
+    playDueNotes(idleMusic, now);
+}
+
+void runScene(void (*scene)()) {
+    governor.noteActivity(millis());
+    scene();
+    enterScene(profIdle);
+    clearParticles();
+    governor.noteActivity(millis());
+    lastPhysicsTime = millis();  // Ghost stays put while a scene runs
+    saveSnapshot();
+}
+
+void handleKeys() {
+    // Copy: scenes started below call update() and replace the live state
+    Keyboard_Class::KeysState keys = M5Cardputer.Keyboard.keysState();
+    governor.noteActivity(millis());
+    for (auto key : keys.word) {
+        if (key == 'f' || key == 'F') runScene(feedScene);
+        else if (key == 'd' || key == 'D') runScene(danceScene);
+        else if (key == 'g' || key == 'G') runScene(gameScene);
+        else if (key == 'a' || key == 'A') runScene(marchScene);
+        else if (key == 'c' || key == 'C') runScene(crowdScene);
+        else if (key == 's' || key == 'S') runScene(statsScene);
+        else if (key == 'p' || key == 'P') hudShown = !hudShown;
+        else if (key == 'm' || key == 'M') {
+            muted = !muted;
+            if (muted) M5Cardputer.Speaker.stop();
+            saveSnapshot();
+        }
+        else if (key == '=' || key == '+') {
+            volume = min(255, volume + 32);
+            M5Cardputer.Speaker.setVolume(volume);
+            saveSnapshot();
+        }
+        else if (key == '-' || key == '_') {
+            volume = max(0, volume - 32);
+            M5Cardputer.Speaker.setVolume(volume);
+            saveSnapshot();
+        }
+        else if (key == '!') enterDownloadMode();
+    }
+}
+
+// Waits out the frame period while keeping the music going. A key press is
+// handled at once and cuts the wait short, so the frame rate ramps up on the
+// very next frame.
+void waitForNextFrame(unsigned long periodMs) {
+    unsigned long start = millis();
+    while (true) {
+        tickMusic(millis());
+
+        pumpInput();
+        if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
+            handleKeys();
+            return;
+        }
+
+        // Wake for the next note as well, so it starts on time
+        unsigned long now = millis();
+        unsigned long elapsed = now - start;
+        if (elapsed >= periodMs) return;
+        unsigned long untilNote = idleMusic.nextAt() - now;
+        if ((long)untilNote <= 0) untilNote = 1;
+        ProfileScope scope(profiler, FrameProfiler::SLEEP);
+        delay(min(min(periodMs - elapsed, idlePollMs), untilNote));
+    }
+}
+
+void printPerfReport() {
+    Serial.printf("Perf: frame rate bands");
+    for (int b = 0; b < FrameGovernor::BAND_COUNT; b++) {
+        FrameGovernor::Band band = (FrameGovernor::Band)b;
+        Serial.printf(" %s(%luHz)=%lums", FrameGovernor::nameOf(band),
+                      1000 / FrameGovernor::periodOf(band), governor.timeInBand(band));
+    }
+    Serial.printf("\n");
+
+    Serial.printf("Perf: effects overruns=%lu adjustments=%lu", effects.overruns(), effects.adjustments());
+    for (int i = 0; i < effects.size(); i++) {
+        Serial.printf(" [%s %d/%d]", effects.name(i), effects.level(i), EffectBudget::FULL_LEVEL);
+    }
+    Serial.printf("\n");
+
+    Serial.printf("Perf: songs %lu bytes, player %u bytes each\n", songBytes, (unsigned)sizeof(SongPlayer));
+    const SongPlayer* players[] = {&idleMusic, &sceneMusic};
+    const char* playerNames[] = {"idle", "scene"};
+    for (int i = 0; i < 2; i++) {
+        Serial.printf("Perf: %s music notes=%lu late avg=%lums max=%lums resyncs=%lu\n", playerNames[i],
+                      players[i]->notesTimed(), players[i]->lateMsAvg(), players[i]->lateMsMax(),
+                      players[i]->resyncs());
+    }
+}
+
 // ============== Main ==============
 
+void drawIntroFrame(unsigned long t) {
+    ProfileScope scope(profiler, FrameProfiler::DRAW);
+    int i = t / introBeatMs;
+    int bounceY = introBounce.at(t);
+    drawGhost(104, bounceY, i % 4 == 0);
+
+    if (i > 4) {
+        for (int s = 0; s < min(i - 4, 6); s++) {
+            drawStar(25 + s * 38, 15, 5 + s % 2, COLOR_STAR);
+        }
+    }
+
+    if (i > 3) {
+        ProfileScope textScope(profiler, FrameProfiler::TEXT);
+        canvas.setTextColor(COLOR_HIGHLIGHT);
+        canvas.setTextSize(3);
+        canvas.setCursor(85, 8);
+        canvas.print("BOO!");
+    }
+
+    if (i > 7) {
+        drawHeart(45, 25, COLOR_HEART);
+        drawHeart(195, 25, COLOR_HEART);
+    }
+}
+
 void setup() {
     auto cfg = M5.config();
     M5Cardputer.begin(cfg, true);
     M5Cardputer.Display.setRotation(1);
     M5Cardputer.Speaker.setVolume(255);  // Max volume
+    bootPhaseDone("m5");
 
 #if !ESP32
     const char* smokeEnv = std::getenv("BOO_SMOKE");
     if (smokeEnv && smokeEnv[0] != '\0') {
         smokeMode = true;
-        muted = true;
-        volume = 0;
-        M5Cardputer.Speaker.setVolume(0);
+        // Keep the sound on when the simulator is capturing it to a file
+        const char* wavEnv = std::getenv("BOO_WAV");
+        if (!wavEnv || wavEnv[0] == '\0') {
+            muted = true;
+            volume = 0;
+            M5Cardputer.Speaker.setVolume(0);
+        }
     }
 #endif
 
     // Create sprite buffer
     canvas.createSprite(SCREEN_WIDTH, SCREEN_HEIGHT);
+    bootPhaseDone("sprite");
 
-    // Initialize sparkles
-    for (int i = 0; i < 8; i++) {
-        sparkles[i] = {static_cast<int>(random(240)),
-                       static_cast<int>(random(100)),
-                       COLOR_SPARKLE,
-                       0};
+    prefs.begin("boo", false);
+    loadPet();
+    bool resumed = !smokeMode && loadSnapshot();
+    bootPhaseDone("prefs");
+
+    hearts.setBounds(0, 6, SCREEN_WIDTH - 1, 129);
+
+    // Intro animation, skipped when resuming
+    const unsigned long introMs = resumed ? 0 : 15 * introBeatMs;
+    unsigned long introStart = millis();
+    enterScene(profIntro);
+    if (!resumed) sceneMusic.start(&introSong, introStart);
+    for (unsigned long t = 0; t < introMs; t = millis() - introStart) {
+        unsigned long frameStart = micros();
+
+        // Rising arpeggio
+        playDueNotes(sceneMusic, millis());
+
+        clearFrame();
+        drawIntroFrame(t);
+        presentFrame();
+        finishFrame(frameStart);
     }
 
-    // Intro animation
-    const int introMelody[] = {NOTE_C4, NOTE_E4, NOTE_G4, NOTE_C5, NOTE_E5, NOTE_G5};
-    for (int i = 0; i < 15; i++) {
-        canvas.fillSprite(COLOR_BG);
-
-        int bounceY = 60 - abs(7 - i) * 5;
-        drawGhost(104, bounceY, i % 4 == 0);
-
-        if (i > 4) {
-            for (int s = 0; s < min(i - 4, 6); s++) {
-                drawStar(25 + s * 38, 15, 5 + s % 2, COLOR_STAR);
-            }
-        }
-
-        if (i > 3) {
-            canvas.setTextColor(COLOR_HIGHLIGHT);
-            canvas.setTextSize(3);
-            canvas.setCursor(85, 8);
-            canvas.print("BOO!");
-        }
-
-        if (i > 7) {
-            drawHeart(45, 25, COLOR_HEART);
-            drawHeart(195, 25, COLOR_HEART);
-        }
-
+    if (!resumed) {
+        canvas.setTextColor(COLOR_TEXT);
+        canvas.setTextSize(1);
+        canvas.setCursor(50, 118);
+        canvas.print("Your ghostly friend!");
         canvas.pushSprite(0, 0);
-
-        if (i < 6) playNote(introMelody[i], 100);
-        else delay(100);
+        delay(800);
+        game.init(); // Initialize using library
     }
+    bootPhaseDone("intro");
 
-    canvas.setTextColor(COLOR_TEXT);
-    canvas.setTextSize(1);
-    canvas.setCursor(50, 118);
-    canvas.print("Your ghostly friend!");
-    canvas.pushSprite(0, 0);
-    delay(800);
-
-    // Init
-    prefs.begin("boo", false);
-    randomSeed(analogRead(0) + millis());
-
-    game.init(); // Initialize using library
+    // Init. One draw of boot entropy seeds the game's generator; it passes
+    // through randomSeed() so the simulator can record and replay it.
+    randomSeed(esp_random() & 0x7FFFFFFF);
+    game.seed(random(0x7FFFFFFF));
+    lastPhysicsTime = millis();
+    governor.reset(millis());
+    enterScene(profIdle);
 
     Serial.begin(115200);
+#if !ESP32
+    std::atexit(printPerfReport);
+    std::atexit(printProfileReport);
+    simSetStateHash([]() { return game.stateHash(); });
+#endif
+    bootPhaseDone("init");
+    printBootReport(resumed);
 }
 
 void loop() {
@@ -937,6 +1641,7 @@ void loop() {
             runSmokeSequence();
         }
 #if !ESP32
+        printSmokeSummary();
         std::exit(0);
 #else
         delay(1000);
@@ -946,76 +1651,165 @@ void loop() {
 
     unsigned long now = millis();
 
-    // Update ghost physics
-    game.update(); 
-
-    // Update sparkles
-    for (int i = 0; i < 8; i++) {
-        if (sparkles[i].life > 0) {
-            sparkles[i].life--;
-        } else if (random(100) < 3) {
-            sparkles[i] = {static_cast<int>(random(240)),
-                           static_cast<int>(random(100)),
-                           static_cast<uint16_t>(random(2) ? COLOR_SPARKLE : COLOR_STAR),
-                           static_cast<int>(random(10, 30))};
+    // The game turns elapsed time into fixed steps; sparkle lifetimes tick
+    // with the same steps, so neither depends on the frame rate the governor
+    // picked
+    {
+        ProfileScope scope(profiler, FrameProfiler::UPDATE);
+        int steps = game.update(now - lastPhysicsTime);
+        for (int step = 0; step < steps; step++) {
+            sparkles.step();
+            sparkles.trickle(idleSparkle, 3, game.rng());
         }
     }
+    lastPhysicsTime = now;
 
     // Draw frame
+    clearFrame();
+    drawIdleFrame();
+
+    // Push to display
+    presentFrame();
+
+    // Handle input and music until the next frame is due
+    waitForNextFrame(governor.framePeriod(now));
+    frameDone();
+}
+
+#ifdef BOO_BENCH
+// ============== Benchmark Kernels ==============
+// What src/bench_main.cpp times. Scene frames are drawn at a fixed moment
+// with their effects at full level, so runs compare like with like.
+
+void benchFillCircle(int r) { canvas.fillCircle(120, 67, r, COLOR_GHOST); }
+void benchFillTriangle(int size) {
+    canvas.fillTriangle(120, 67 - size, 120 - size, 67 + size, 120 + size, 67 + size, COLOR_STAR);
+}
+void benchDrawLine(int len) { canvas.drawLine(60, 30, 60 + len, 30 + len / 2, COLOR_BG); }
+void benchText(int size) {
+    canvas.setTextColor(COLOR_STAR);
+    canvas.setTextSize(size);
+    canvas.setCursor(5, 60);
+    canvas.print("SO YUMMY!");
+}
+
+void benchGhost(int pose) { drawGhost(104, 50, pose == 1, pose == 2, 3); }
+void benchGhostEating(int frame) { drawGhostEating(104, 50, frame); }
+void benchHeart(int) { drawHeart(120, 67, COLOR_HEART); }
+void benchStar(int size) { drawStar(120, 67, size, COLOR_STAR); }
+void benchFood(int i) { foodItems[i].draw(98, 40, 2); }
+
+void benchIdleSetup(int) {
+    clearParticles();
+    game.init();
+    sparkles.emit(idleSparkle, sparkles.capacity(), game.rng());
+}
+void benchIdleFrame(int) {
     canvas.fillSprite(COLOR_BG);
+    drawIdleFrame();
+}
 
-    // Draw sparkles
-    for (int i = 0; i < 8; i++) {
-        if (sparkles[i].life > 0) {
-            drawSparkle(sparkles[i].x, sparkles[i].y, sparkles[i].color);
-        }
+void benchIntroFrame(int t) {
+    canvas.fillSprite(COLOR_BG);
+    drawIntroFrame(t);
+}
+
+void benchFeedFoodFrame(int i) {
+    canvas.fillSprite(COLOR_BG);
+    drawFeedFood(foodItems[i], 0);
+}
+
+void benchFeedEatingSetup(int) {
+    clearParticles();
+    hearts.emit(risingHeart, feedHearts, game.rng());
+    for (int s = 0; s < 6; s++) {
+        stars.spawn(120, 65, burstDir[s][0] * burstSpeed, burstDir[s][1] * burstSpeed, 1000, 4, COLOR_STAR);
     }
+}
+void benchFeedEatingFrame(int t) {
+    canvas.fillSprite(COLOR_BG);
+    drawFeedEating(t);
+}
 
-    // Draw ghost using state from library
-    drawGhost((int)game.getGhostX(), (int)game.getGhostY(), game.isBlinking());
+void benchCheerSetup(int) {
+    clearParticles();
+    stars.emit(cheerStar, 12, game.rng());
+}
+void benchCheerFrame(int t) {
+    canvas.fillSprite(COLOR_BG);
+    drawFeedCelebration(t);
+}
 
-    // Draw UI hints
-    canvas.setTextColor(COLOR_TEXT);
-    canvas.setTextSize(1);
-    canvas.setCursor(5, SCREEN_HEIGHT - 12);
-    canvas.printf("F:Feed D:Dance G:Game A:March M:%s", muted ? "OFF" : "ON");
+void benchDanceSetup(int) {
+    clearParticles();
+    sparkles.emit(danceSparkle, 5, game.rng());
+}
+void benchDanceFrame(int t) {
+    canvas.fillSprite(COLOR_BG);
+    drawDanceFrame(t, 3);
+}
 
-    // Push to display
-    canvas.pushSprite(0, 0);
+void benchMarchFrame(int t) {
+    canvas.fillSprite(COLOR_BG);
+    drawMarchFrame(t);
+}
 
-    // Play Happy Birthday (non-blocking)
-    if (!muted && now - lastNoteTime > (unsigned long)happyBirthdayDurations[musicIndex]) {
-        musicIndex = (musicIndex + 1) % happyBirthdayLen;
-        if (happyBirthday[musicIndex] > 0) {
-            M5Cardputer.Speaker.tone(happyBirthday[musicIndex], happyBirthdayDurations[musicIndex] - 30);
-        }
-        lastNoteTime = now;
-    }
+void benchCatchFrame(int starX) {
+    canvas.fillSprite(COLOR_BG);
+    drawCatchFrame(104, starX, 2, 5);
+}
 
-    // Handle input
-    M5Cardputer.update();
-    if (M5Cardputer.Keyboard.isChange() && M5Cardputer.Keyboard.isPressed()) {
-        Keyboard_Class::KeysState keys = M5Cardputer.Keyboard.keysState();
-        for (auto key : keys.word) {
-            if (key == 'f' || key == 'F') feedScene();
-            else if (key == 'd' || key == 'D') danceScene();
-            else if (key == 'g' || key == 'G') gameScene();
-            else if (key == 'a' || key == 'A') marchScene();
-            else if (key == 'm' || key == 'M') {
-                muted = !muted;
-                if (muted) M5Cardputer.Speaker.stop();
-            }
-            else if (key == '=' || key == '+') {
-                volume = min(255, volume + 32);
-                M5Cardputer.Speaker.setVolume(volume);
-            }
-            else if (key == '-' || key == '_') {
-                volume = max(0, volume - 32);
-                M5Cardputer.Speaker.setVolume(volume);
-            }
-            else if (key == '!') enterDownloadMode();
-        }
-    }
+GhostCrowd benchCrowd(32);
+void benchCrowdSetup(int) { scatterCrowd(benchCrowd); }
+void benchCrowdFrame(int) {
+    canvas.fillSprite(COLOR_BG);
+    drawCrowdFrame(benchCrowd, benchCrowd.size());
+}
+
+// Three days old and never fed, so the longer hungry label shows
+void benchStatsSetup(int) { pet.hatch(petClock() - 3 * 86400); }
+void benchStatsFrame(int) {
+    canvas.fillSprite(COLOR_BG);
+    drawStatsFrame(petClock());
+}
+
+int benchRenderKernels(BenchKernel* out, int max) {
+    // The kernels are timed without the profiler's scopes
+    profiler.setEnabled(false);
+    const BenchKernel kernels[] = {
+        {"primitive", "fillCircle r4", nullptr, benchFillCircle, 4},
+        {"primitive", "fillCircle r16", nullptr, benchFillCircle, 16},
+        {"primitive", "fillTriangle 20px", nullptr, benchFillTriangle, 10},
+        {"primitive", "fillTriangle 60px", nullptr, benchFillTriangle, 30},
+        {"primitive", "drawLine 40px", nullptr, benchDrawLine, 40},
+        {"primitive", "text 9ch size1", nullptr, benchText, 1},
+        {"primitive", "text 9ch size2", nullptr, benchText, 2},
+        {"composite", "drawGhost", nullptr, benchGhost, 0},
+        {"composite", "drawGhost blinking", nullptr, benchGhost, 1},
+        {"composite", "drawGhost dancing", nullptr, benchGhost, 2},
+        {"composite", "drawGhostEating", nullptr, benchGhostEating, 0},
+        {"composite", "drawHeart", nullptr, benchHeart, 0},
+        {"composite", "drawStar 6", nullptr, benchStar, 6},
+        {"frame", "idle", benchIdleSetup, benchIdleFrame, 0},
+        {"frame", "intro", nullptr, benchIntroFrame, 1200},
+        {"frame", "feed food", nullptr, benchFeedFoodFrame, 0},
+        {"frame", "feed eating", benchFeedEatingSetup, benchFeedEatingFrame, 400},
+        {"frame", "feed cheer", benchCheerSetup, benchCheerFrame, 100},
+        {"frame", "dance", benchDanceSetup, benchDanceFrame, 1000},
+        {"frame", "march", nullptr, benchMarchFrame, 1000},
+        {"frame", "catch", nullptr, benchCatchFrame, 100},
+        {"frame", "crowd 32", benchCrowdSetup, benchCrowdFrame, 0},
+        {"frame", "stats", benchStatsSetup, benchStatsFrame, 0},
+    };
+    const int fixed = sizeof(kernels) / sizeof(kernels[0]);
 
-    delay(33);  // ~30 FPS
+    int n = 0;
+    for (int i = 0; i < fixed; i++, n++) {
+        if (n < max) out[n] = kernels[i];
+    }
+    for (int i = 0; i < foodCount; i++, n++) {
+        if (n < max) out[n] = {"food", foodItems[i].name, nullptr, benchFood, i};
+    }
+    return n;
 }
+#endif
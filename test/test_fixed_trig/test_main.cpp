@@ -0,0 +1,66 @@
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "FixedTrig.h"
+
+// Within two Q15 steps of double sin/cos, over every angle
+#define MAX_ERROR_STEPS 2.0
+
+void setUp() {}
+void tearDown() {}
+
+void test_error_bound_over_every_angle() {
+    double worst = 0;
+    long worstAngle = 0;
+    for (long a = 0; a < TRIG_TURN; a++) {
+        double rad = a * (2 * M_PI / TRIG_TURN);
+        double es = fabs(isin((uint16_t)a) - sin(rad) * TRIG_ONE);
+        double ec = fabs(icos((uint16_t)a) - cos(rad) * TRIG_ONE);
+        double e = es > ec ? es : ec;
+        if (e > worst) {
+            worst = e;
+            worstAngle = a;
+        }
+    }
+    char message[64];
+    snprintf(message, sizeof(message), "worst at angle %ld: %.2f steps", worstAngle, worst);
+    TEST_ASSERT_TRUE_MESSAGE(worst <= MAX_ERROR_STEPS, message);
+}
+
+void test_quarter_turns_are_exact() {
+    TEST_ASSERT_EQUAL_INT16(0, isin(0));
+    TEST_ASSERT_EQUAL_INT16(TRIG_ONE, isin(TRIG_TURN / 4));
+    TEST_ASSERT_EQUAL_INT16(0, isin(TRIG_TURN / 2));
+    TEST_ASSERT_EQUAL_INT16(-TRIG_ONE, isin(3 * TRIG_TURN / 4));
+
+    TEST_ASSERT_EQUAL_INT16(TRIG_ONE, icos(0));
+    TEST_ASSERT_EQUAL_INT16(0, icos(TRIG_TURN / 4));
+    TEST_ASSERT_EQUAL_INT16(-TRIG_ONE, icos(TRIG_TURN / 2));
+    TEST_ASSERT_EQUAL_INT16(0, icos(3 * TRIG_TURN / 4));
+}
+
+// sin is odd and cos even: mirroring the angle flips sin and keeps cos
+void test_symmetry() {
+    for (long a = 0; a < TRIG_TURN; a++) {
+        uint16_t angle = (uint16_t)a;
+        uint16_t mirrored = (uint16_t)(TRIG_TURN - a);
+        TEST_ASSERT_EQUAL_INT16(-isin(angle), isin(mirrored));
+        TEST_ASSERT_EQUAL_INT16(icos(angle), icos(mirrored));
+    }
+}
+
+void test_degrees() {
+    TEST_ASSERT_EQUAL_UINT16(TRIG_TURN / 4, TRIG_DEG(90));
+    TEST_ASSERT_EQUAL_UINT16(TRIG_TURN / 2, TRIG_DEG(180));
+    TEST_ASSERT_EQUAL_UINT16(0, TRIG_DEG(360));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_error_bound_over_every_angle);
+    RUN_TEST(test_quarter_turns_are_exact);
+    RUN_TEST(test_symmetry);
+    RUN_TEST(test_degrees);
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include <unity.h>
+
+#include "PetStats.h"
+
+#define HOUR 3600u
+
+void setUp() {}
+void tearDown() {}
+
+static PetState stateAt(uint32_t anchorAt, uint16_t hunger, uint16_t happiness) {
+    PetState s = {};
+    s.anchorAt = anchorAt;
+    s.hunger = hunger;
+    s.happiness = happiness;
+    return s;
+}
+
+void test_hatch_and_steady_hunger() {
+    PetStats pet;
+    pet.hatch(1000);
+    TEST_ASSERT_EQUAL_UINT16(0, pet.hunger(1000));
+    TEST_ASSERT_EQUAL_UINT16(800, pet.happiness(1000));
+    TEST_ASSERT_EQUAL_UINT16(PetStats::HUNGER_PER_HOUR, pet.hunger(1000 + HOUR));
+    TEST_ASSERT_EQUAL_UINT16(PetStats::MAX, pet.hunger(1000 + 30 * HOUR));
+    TEST_ASSERT_EQUAL_UINT32(2 * HOUR, pet.ageSeconds(1000 + 2 * HOUR));
+}
+
+// Happiness drains at the calm rate up to the hungry moment and at the
+// hungry rate after it
+void test_happiness_splits_at_the_hungry_point() {
+    PetStats pet;
+    pet.restore(stateAt(0, 650, 800), 0);
+    TEST_ASSERT_EQUAL_UINT32(HOUR, pet.secondsUntilHungry(0));
+    TEST_ASSERT_FALSE(pet.isHungry(HOUR - 1));
+    TEST_ASSERT_TRUE(pet.isHungry(HOUR));
+    TEST_ASSERT_EQUAL_UINT32(0, pet.secondsUntilHungry(HOUR));
+    TEST_ASSERT_EQUAL_UINT16(800 - PetStats::GLOOM_PER_HOUR, pet.happiness(HOUR));
+    TEST_ASSERT_EQUAL_UINT16(800 - PetStats::GLOOM_PER_HOUR - PetStats::HUNGRY_GLOOM_PER_HOUR,
+                             pet.happiness(2 * HOUR));
+}
+
+// Playing half way to the hungry point makes the pet hungry at once; from
+// there happiness drains at the hungry rate
+void test_rebase_across_the_hungry_point() {
+    PetStats pet;
+    pet.restore(stateAt(0, 650, 800), 0);
+    pet.play(HOUR / 2);
+    TEST_ASSERT_EQUAL_UINT16(650 + 25 + 50, pet.hunger(HOUR / 2));
+    TEST_ASSERT_TRUE(pet.isHungry(HOUR / 2));
+    TEST_ASSERT_EQUAL_UINT16(800 - 10 + 150, pet.happiness(HOUR / 2));
+    TEST_ASSERT_EQUAL_UINT16(940 - PetStats::HUNGRY_GLOOM_PER_HOUR, pet.happiness(HOUR / 2 + HOUR));
+}
+
+// Acting more often than a stat point takes to build up must not lose the
+// time in between: 50 hunger/h is one point every 72s, 20 gloom/h one
+// every 180s
+void test_repeated_rebasing_keeps_partial_points() {
+    PetStats pet;
+    pet.restore(stateAt(0, 0, 100), 0);
+    for (uint32_t t = 120; t <= 600; t += 120) pet.play(t);
+    // 5 plays, plus 600s of hunger (8.3 points) and gloom (3.3 points)
+    TEST_ASSERT_EQUAL_UINT16(250 + 8, pet.hunger(600));
+    TEST_ASSERT_EQUAL_UINT16(100 + 750 - 4, pet.happiness(600));
+}
+
+void test_clock_going_backwards() {
+    PetStats pet;
+    pet.hatch(10000);
+    // Earlier than the anchor: no time has passed, and the anchor stays
+    TEST_ASSERT_EQUAL_UINT16(0, pet.hunger(5000));
+    pet.play(5000);
+    TEST_ASSERT_EQUAL_UINT16(50, pet.hunger(10000));
+    TEST_ASSERT_EQUAL_UINT16(100, pet.hunger(10000 + HOUR));
+
+    // A saved pet read after the clock restarted picks up from the new time
+    PetStats resumed;
+    resumed.restore(stateAt(10000, 100, 500), 500);
+    TEST_ASSERT_EQUAL_UINT16(100, resumed.hunger(500));
+    TEST_ASSERT_EQUAL_UINT16(150, resumed.hunger(500 + HOUR));
+}
+
+void test_stats_stay_in_range() {
+    PetStats pet;
+    pet.restore(stateAt(0, 990, 5), 0);
+    pet.play(0);
+    TEST_ASSERT_EQUAL_UINT16(PetStats::MAX, pet.hunger(0));
+    TEST_ASSERT_EQUAL_UINT16(PetStats::MAX, pet.hunger(HOUR));
+    TEST_ASSERT_EQUAL_UINT16(0, pet.happiness(100 * HOUR));
+    pet.feed(100 * HOUR);
+    TEST_ASSERT_EQUAL_UINT16(PetStats::MAX - 300, pet.hunger(100 * HOUR));
+    TEST_ASSERT_EQUAL_UINT16(100, pet.happiness(100 * HOUR));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hatch_and_steady_hunger);
+    RUN_TEST(test_happiness_splits_at_the_hungry_point);
+    RUN_TEST(test_rebase_across_the_hungry_point);
+    RUN_TEST(test_repeated_rebasing_keeps_partial_points);
+    RUN_TEST(test_clock_going_backwards);
+    RUN_TEST(test_stats_stay_in_range);
+    return UNITY_END();
+}